@@ -0,0 +1,237 @@
+//
+// Standalone benchmark of the heating/cooling integrators.
+//
+// A single box holds a grid of (overdensity, temperature) cells.  For every
+// requested redshift and time step the state is advanced once with a tightly
+// converged Runge-Kutta reference, and then with each integrator selected by
+// hc.heat_cool_types, reporting cells/sec, RHS calls and integrator steps per
+// cell, and the relative error in e, T and Ne.  Only the UV background file is
+// read; everything else comes from the hc.* parameters.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <limits>
+
+#include "AMReX_ParmParse.H"
+#include "AMReX_ParallelDescriptor.H"
+#include "AMReX_Utility.H"
+#include "AMReX_FArrayBox.H"
+#include "AMReX_BLFort.H"
+
+#include "uvb_table.H"
+
+using namespace amrex;
+
+extern "C"
+{
+  void fort_hc_bench_setup
+    (const int* ncooltab, int* nvar);
+
+  void fort_hc_bench_set_type
+    (const int* heat_cool_type);
+
+  void fort_hc_bench_init
+    (const int* lo, const int* hi,
+     BL_FORT_FAB_ARG(state),
+     BL_FORT_FAB_ARG(diag_eos),
+     const Real* omb_h2,
+     const Real* log_delta_min, const Real* log_delta_max,
+     const Real* log_T_min, const Real* log_T_max,
+     const Real* a);
+
+  void fort_hc_bench_reference
+    (const int* lo, const int* hi,
+     BL_FORT_FAB_ARG(state),
+     BL_FORT_FAB_ARG(diag_eos),
+     const Real* a, const Real* dt, const Real* rtol);
+
+  void fort_hc_bench_compare
+    (const int* lo, const int* hi,
+     const BL_FORT_FAB_ARG(state),
+     const BL_FORT_FAB_ARG(diag_eos),
+     const BL_FORT_FAB_ARG(ref),
+     const BL_FORT_FAB_ARG(ref_eos),
+     Real* max_err, Real* mean_err);
+
+  void fort_set_uvb_table
+    (const int* nrows, const Real* table);
+
+  void integrate_state
+    (const int* lo, const int* hi,
+     BL_FORT_FAB_ARG(state),
+     BL_FORT_FAB_ARG(diag_eos),
+     BL_FORT_FAB_ARG(hc_cost),
+     const Real* a, const Real* dt,
+     const int* min_iter, const int* max_iter);
+}
+
+//
+// The same table Nyx::read_uvb_table loads, without the broadcast.
+//
+static
+void
+read_uvb_table (const std::string& uvb_file)
+{
+    Array<Real> table;
+    int nrows = read_uvb_file(uvb_file, table);
+    fort_set_uvb_table(&nrows, table.dataPtr());
+}
+
+int
+main (int   argc,
+      char* argv[])
+{
+    amrex::Initialize(argc,argv);
+
+    if (ParallelDescriptor::NProcs() > 1)
+        amrex::Abort("hc_bench: run on a single rank");
+
+    ParmParse pp("hc");
+
+    int  n_rho = 64;
+    int  n_T   = 64;
+    Real log_delta_min = -1.0;
+    Real log_delta_max =  3.0;
+    Real log_T_min     =  3.0;
+    Real log_T_max     =  7.0;
+    Real omb_h2        =  0.0224;
+    int  cooling_table_size = 2000;
+    int  nrepeat       =  3;
+    Real ref_rtol      =  1.e-8;
+    std::string uvb_file = "../../LyA/TREECOOL_middle";
+
+    pp.query("n_rho", n_rho);
+    pp.query("n_T", n_T);
+    pp.query("log_delta_min", log_delta_min);
+    pp.query("log_delta_max", log_delta_max);
+    pp.query("log_T_min", log_T_min);
+    pp.query("log_T_max", log_T_max);
+    pp.query("omb_h2", omb_h2);
+    pp.query("cooling_table_size", cooling_table_size);
+    pp.query("nrepeat", nrepeat);
+    pp.query("ref_rtol", ref_rtol);
+    pp.query("uvb_file", uvb_file);
+
+    Array<Real> redshifts(1, 3.0);
+    if (pp.contains("redshifts"))
+        pp.getarr("redshifts", redshifts);
+
+    // In code units (Mpc km^-1 s); f_rhs rejects anything above 1
+    Array<Real> dts(1, 1.e-4);
+    if (pp.contains("dts"))
+        pp.getarr("dts", dts);
+
+    Array<int> heat_cool_types(2);
+    heat_cool_types[0] = 1;
+    heat_cool_types[1] = 3;
+    if (pp.contains("heat_cool_types"))
+        pp.getarr("heat_cool_types", heat_cool_types);
+
+    if (n_rho < 1 || n_T < 1 || nrepeat < 1)
+        amrex::Error("hc_bench: n_rho, n_T and nrepeat must be positive");
+    for (int n = 0; n < dts.size(); n++)
+        if (dts[n] <= 0 || dts[n] > 1)
+            amrex::Error("hc_bench: each of hc.dts must be in (0,1]");
+    for (int n = 0; n < heat_cool_types.size(); n++)
+        if (heat_cool_types[n] != 1 && heat_cool_types[n] != 3)
+            amrex::Error("hc_bench: hc.heat_cool_types may only contain 1 and 3");
+
+    int nvar;
+    fort_hc_bench_setup(&cooling_table_size, &nvar);
+    read_uvb_table(uvb_file);
+
+    const Box bx(IntVect(D_DECL(0,0,0)), IntVect(D_DECL(n_rho-1,n_T-1,0)));
+    const Real ncells = bx.numPts();
+
+    FArrayBox S_init(bx,nvar), D_init(bx,2);
+    FArrayBox S_ref (bx,nvar), D_ref (bx,2);
+    FArrayBox S     (bx,nvar), D     (bx,2);
+    FArrayBox hc_cost(bx,2);
+
+    std::cout << "Heating/cooling benchmark on " << n_rho << " x " << n_T << " cells"
+              << ", log10(delta) in [" << log_delta_min << "," << log_delta_max << "]"
+              << ", log10(T) in ["     << log_T_min     << "," << log_T_max     << "]"
+              << ", " << cooling_table_size << " rate table entries\n\n";
+
+    std::cout << std::setw(8)  << "z"
+              << std::setw(12) << "dt"
+              << std::setw(6)  << "type"
+              << std::setw(14) << "cells/sec"
+              << std::setw(10) << "RHS/cell"
+              << std::setw(10) << "step/cell"
+              << std::setw(12) << "max err e"
+              << std::setw(12) << "mean err e"
+              << std::setw(12) << "max err T"
+              << std::setw(12) << "max err ne" << '\n';
+
+    for (int iz = 0; iz < redshifts.size(); iz++)
+    {
+        const Real a = 1.0 / (1.0 + redshifts[iz]);
+
+        fort_hc_bench_init(bx.loVect(), bx.hiVect(),
+                           BL_TO_FORTRAN(S_init), BL_TO_FORTRAN(D_init),
+                           &omb_h2, &log_delta_min, &log_delta_max,
+                           &log_T_min, &log_T_max, &a);
+
+        for (int idt = 0; idt < dts.size(); idt++)
+        {
+            const Real dt = dts[idt];
+
+            S_ref.copy(S_init);
+            D_ref.copy(D_init);
+            fort_hc_bench_reference(bx.loVect(), bx.hiVect(),
+                                    BL_TO_FORTRAN(S_ref), BL_TO_FORTRAN(D_ref),
+                                    &a, &dt, &ref_rtol);
+
+            for (int it = 0; it < heat_cool_types.size(); it++)
+            {
+                fort_hc_bench_set_type(&heat_cool_types[it]);
+
+                // Best of nrepeat, each from the same initial state
+                Real best_time = std::numeric_limits<Real>::max();
+                for (int rep = 0; rep < nrepeat; rep++)
+                {
+                    S.copy(S_init);
+                    D.copy(D_init);
+                    hc_cost.setVal(0);
+
+                    int min_iter = 100000;
+                    int max_iter =      0;
+
+                    const Real strt_time = ParallelDescriptor::second();
+
+                    integrate_state(bx.loVect(), bx.hiVect(),
+                                    BL_TO_FORTRAN(S), BL_TO_FORTRAN(D),
+                                    BL_TO_FORTRAN(hc_cost),
+                                    &a, &dt, &min_iter, &max_iter);
+
+                    best_time = std::min(best_time, ParallelDescriptor::second() - strt_time);
+                }
+
+                Real max_err[3], mean_err[3];
+                fort_hc_bench_compare(bx.loVect(), bx.hiVect(),
+                                      BL_TO_FORTRAN(S), BL_TO_FORTRAN(D),
+                                      BL_TO_FORTRAN(S_ref), BL_TO_FORTRAN(D_ref),
+                                      max_err, mean_err);
+
+                std::cout << std::setw(8)  << redshifts[iz]
+                          << std::setw(12) << dt
+                          << std::setw(6)  << heat_cool_types[it]
+                          << std::setw(14) << ncells / best_time
+                          << std::setw(10) << hc_cost.sum(0) / ncells
+                          << std::setw(10) << hc_cost.sum(1) / ncells
+                          << std::setw(12) << max_err[0]
+                          << std::setw(12) << mean_err[0]
+                          << std::setw(12) << max_err[1]
+                          << std::setw(12) << max_err[2] << '\n';
+            }
+        }
+    }
+
+    amrex::Finalize();
+
+    return 0;
+}
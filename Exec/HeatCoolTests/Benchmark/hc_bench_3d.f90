@@ -0,0 +1,309 @@
+! *************************************************************************************
+! Setup, initial conditions and reference solution for the standalone
+! heating/cooling benchmark.  The state only carries what the integrators touch:
+! density, three (zero) momenta, (rho E) and (rho e).
+! *************************************************************************************
+
+subroutine fort_hc_bench_setup(ncooltab, nvar_out) &
+    bind(C, name="fort_hc_bench_setup")
+
+    use meth_params_module
+    use atomic_rates_module, only : tabulate_rates
+
+    implicit none
+
+    integer, intent(in   ) :: ncooltab
+    integer, intent(  out) :: nvar_out
+
+    URHO  = 1
+    UMX   = 2
+    UMY   = 3
+    UMZ   = 4
+    UEDEN = 5
+    UEINT = 6
+    NVAR  = 6
+
+    TEMP_COMP = 1
+    NE_COMP   = 2
+
+    gamma_const   = 5.d0/3.d0
+    gamma_minus_1 = gamma_const - 1.d0
+
+    heat_cool_type = 3
+
+    call tabulate_rates(ncooltab)
+
+    nvar_out = NVAR
+
+end subroutine fort_hc_bench_setup
+
+! *************************************************************************************
+
+subroutine fort_hc_bench_set_type(heat_cool_type_in) &
+    bind(C, name="fort_hc_bench_set_type")
+
+    use meth_params_module, only : heat_cool_type
+
+    implicit none
+
+    integer, intent(in) :: heat_cool_type_in
+
+    heat_cool_type = heat_cool_type_in
+
+end subroutine fort_hc_bench_set_type
+
+! *************************************************************************************
+
+subroutine fort_hc_bench_init(lo, hi, &
+                              state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
+                              diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                              omb_h2, log_delta_lo, log_delta_hi, log_T_lo, log_T_hi, a) &
+    bind(C, name="fort_hc_bench_init")
+!
+!   Overdensity (relative to the mean baryon density for omb_h2 = Omega_b h^2)
+!   is log-spaced along i, temperature along j.  (rho e) is set from T with the
+!   equilibrium Ne at that (rho, T).
+!
+    use amrex_fort_module, only : rt => amrex_real
+    use fundamental_constants_module, only : Gconst
+    use bl_constants_module, only : M_PI
+    use meth_params_module, only : NVAR, URHO, UMX, UMY, UMZ, UEDEN, UEINT, &
+                                   TEMP_COMP, NE_COMP
+    use eos_module, only: nyx_eos_T_given_Re, nyx_eos_given_RT
+    use atomic_rates_module, only: interp_to_this_z
+
+    implicit none
+
+    integer , intent(in   ) :: lo(3), hi(3)
+    integer , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+    integer , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    real(rt), intent(inout) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
+    real(rt), intent(inout) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(in   ) :: omb_h2, log_delta_lo, log_delta_hi, log_T_lo, log_T_hi, a
+
+    integer  :: i, j, k, n
+    real(rt) :: rho_mean, rho, T, T_eos, ne, e, pres, fi, fj
+
+    ! Comoving mean baryon density, 3 H0^2 Omega_b / (8 pi G) with H0 = 100 h
+    rho_mean = 3.d0 * 100.d0**2 * omb_h2 / (8.d0 * M_PI * Gconst)
+
+    call interp_to_this_z(1.d0/a - 1.d0)
+
+    do k = lo(3),hi(3)
+        do j = lo(2),hi(2)
+            do i = lo(1),hi(1)
+
+                fi = 0.d0
+                fj = 0.d0
+                if (hi(1) .gt. lo(1)) fi = dble(i-lo(1)) / dble(hi(1)-lo(1))
+                if (hi(2) .gt. lo(2)) fj = dble(j-lo(2)) / dble(hi(2)-lo(2))
+
+                rho = rho_mean * 10.d0**(log_delta_lo + fi*(log_delta_hi-log_delta_lo))
+                T   =            10.d0**(log_T_lo     + fj*(log_T_hi    -log_T_lo    ))
+
+                ! Ne depends only weakly on e, so a few fixed-point passes suffice
+                ne = 1.d0
+                do n = 1, 10
+                   call nyx_eos_given_RT(e, pres, rho, T, ne, a)
+                   T_eos = T
+                   call nyx_eos_T_given_Re(T_eos, ne, rho, e, a)
+                end do
+                call nyx_eos_given_RT(e, pres, rho, T, ne, a)
+
+                state(i,j,k,URHO)  = rho
+                state(i,j,k,UMX)   = 0.d0
+                state(i,j,k,UMY)   = 0.d0
+                state(i,j,k,UMZ)   = 0.d0
+                state(i,j,k,UEINT) = rho * e
+                state(i,j,k,UEDEN) = rho * e
+
+                diag_eos(i,j,k,TEMP_COMP) = T
+                diag_eos(i,j,k,  NE_COMP) = ne
+
+            end do
+        end do
+    end do
+
+end subroutine fort_hc_bench_init
+
+! *************************************************************************************
+
+subroutine fort_hc_bench_reference(lo, hi, &
+                                   state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
+                                   diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                   a, dt, rtol) &
+    bind(C, name="fort_hc_bench_reference")
+!
+!   Reference solution: adaptive Cash-Karp Runge-Kutta on e, with the same
+!   right-hand side (f_rhs) as VODE but a much tighter tolerance.
+!
+    use amrex_fort_module, only : rt => amrex_real
+    use meth_params_module, only : NVAR, URHO, UEDEN, UEINT, TEMP_COMP, NE_COMP
+    use eos_module, only: nyx_eos_T_given_Re
+    use atomic_rates_module, only: interp_to_this_z
+    use vode_aux_module, only: z_vode, rho_vode, T_vode, ne_vode, i_vode, j_vode, k_vode
+
+    implicit none
+
+    integer , intent(in   ) :: lo(3), hi(3)
+    integer , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+    integer , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    real(rt), intent(inout) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
+    real(rt), intent(inout) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(in   ) :: a, dt, rtol
+
+    ! Cash-Karp tableau
+    real(rt), parameter :: a2 = 0.2d0, a3 = 0.3d0, a4 = 0.6d0, a5 = 1.d0, a6 = 0.875d0
+    real(rt), parameter :: b21 = 0.2d0
+    real(rt), parameter :: b31 = 3.d0/40.d0, b32 = 9.d0/40.d0
+    real(rt), parameter :: b41 = 0.3d0, b42 = -0.9d0, b43 = 1.2d0
+    real(rt), parameter :: b51 = -11.d0/54.d0, b52 = 2.5d0, b53 = -70.d0/27.d0, b54 = 35.d0/27.d0
+    real(rt), parameter :: b61 = 1631.d0/55296.d0, b62 = 175.d0/512.d0, b63 = 575.d0/13824.d0
+    real(rt), parameter :: b64 = 44275.d0/110592.d0, b65 = 253.d0/4096.d0
+    real(rt), parameter :: c1 = 37.d0/378.d0, c3 = 250.d0/621.d0, c4 = 125.d0/594.d0
+    real(rt), parameter :: c6 = 512.d0/1771.d0
+    real(rt), parameter :: d1 = c1 - 2825.d0/27648.d0, d3 = c3 - 18575.d0/48384.d0
+    real(rt), parameter :: d4 = c4 - 13525.d0/55296.d0, d5 = -277.d0/14336.d0
+    real(rt), parameter :: d6 = c6 - 0.25d0
+
+    integer  :: i, j, k
+    real(rt) :: rho, e, e_orig, t, h, err, e_new, T_out, ne_out
+    real(rt) :: k1, k2, k3, k4, k5, k6
+
+    z_vode = 1.d0/a - 1.d0
+    call interp_to_this_z(z_vode)
+
+    do k = lo(3),hi(3)
+        do j = lo(2),hi(2)
+            do i = lo(1),hi(1)
+
+                rho     = state(i,j,k,URHO)
+                e_orig  = state(i,j,k,UEINT) / rho
+                T_vode  = diag_eos(i,j,k,TEMP_COMP)
+                ne_vode = diag_eos(i,j,k,  NE_COMP)
+
+                rho_vode = rho
+                i_vode   = i
+                j_vode   = j
+                k_vode   = k
+
+                e = e_orig
+                t = 0.d0
+                h = dt / 16.d0
+
+                do while (t .lt. dt)
+                   h = min(h, dt - t)
+
+                   call rhs(t          , e                                                   , k1)
+                   call rhs(t + a2*h   , e + h*b21*k1                                        , k2)
+                   call rhs(t + a3*h   , e + h*(b31*k1 + b32*k2)                             , k3)
+                   call rhs(t + a4*h   , e + h*(b41*k1 + b42*k2 + b43*k3)                    , k4)
+                   call rhs(t + a5*h   , e + h*(b51*k1 + b52*k2 + b53*k3 + b54*k4)           , k5)
+                   call rhs(t + a6*h   , e + h*(b61*k1 + b62*k2 + b63*k3 + b64*k4 + b65*k5)  , k6)
+
+                   e_new = e + h*(c1*k1 + c3*k3 + c4*k4 + c6*k6)
+                   err   = abs(h*(d1*k1 + d3*k3 + d4*k4 + d5*k5 + d6*k6)) / (rtol*max(abs(e_new), tiny(e)))
+
+                   if (err .le. 1.d0 .and. e_new .gt. 0.d0) then
+                      if (h .eq. dt - t) then
+                         t = dt
+                      else
+                         t = t + h
+                      end if
+                      e = e_new
+                      h = h * min(5.d0, 0.9d0 * max(err, 1.d-10)**(-0.2d0))
+                   else
+                      h = h * max(0.1d0, 0.9d0 * err**(-0.25d0))
+                   end if
+
+                   if (h .lt. 1.d-14*dt) then
+                      print *,'reference integration stalled at ',i,j,k
+                      call bl_abort('fort_hc_bench_reference: step size underflow')
+                   end if
+                end do
+
+                state(i,j,k,UEINT) = rho * e
+                state(i,j,k,UEDEN) = state(i,j,k,UEDEN) + rho * (e - e_orig)
+
+                T_out  = T_vode
+                ne_out = ne_vode
+                call nyx_eos_T_given_Re(T_out, ne_out, rho, e, a)
+                diag_eos(i,j,k,TEMP_COMP) = T_out
+                diag_eos(i,j,k,  NE_COMP) = ne_out
+
+            end do
+        end do
+    end do
+
+contains
+
+    subroutine rhs(time, e_in, e_dot)
+
+      real(rt), intent(in   ) :: time, e_in
+      real(rt), intent(  out) :: e_dot
+      real(rt) :: y(1), rpar
+      integer  :: ipar
+
+      y(1) = e_in
+      call f_rhs(1, time, y, e_dot, rpar, ipar)
+
+    end subroutine rhs
+
+end subroutine fort_hc_bench_reference
+
+! *************************************************************************************
+
+subroutine fort_hc_bench_compare(lo, hi, &
+                                 state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
+                                 diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                 ref     , r_l1, r_l2, r_l3, r_h1, r_h2, r_h3, &
+                                 ref_eos , e_l1, e_l2, e_l3, e_h1, e_h2, e_h3, &
+                                 max_err, mean_err) &
+    bind(C, name="fort_hc_bench_compare")
+!
+!   Max and mean relative errors in e, T and Ne against the reference.
+!
+    use amrex_fort_module, only : rt => amrex_real
+    use meth_params_module, only : NVAR, URHO, UEINT, TEMP_COMP, NE_COMP
+
+    implicit none
+
+    integer , intent(in   ) :: lo(3), hi(3)
+    integer , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+    integer , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer , intent(in   ) :: r_l1, r_l2, r_l3, r_h1, r_h2, r_h3
+    integer , intent(in   ) :: e_l1, e_l2, e_l3, e_h1, e_h2, e_h3
+    real(rt), intent(in   ) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
+    real(rt), intent(in   ) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(in   ) ::      ref(r_l1:r_h1, r_l2:r_h2,r_l3:r_h3, NVAR)
+    real(rt), intent(in   ) ::  ref_eos(e_l1:e_h1, e_l2:e_h2,e_l3:e_h3, 2)
+    real(rt), intent(  out) :: max_err(3), mean_err(3)
+
+    integer  :: i, j, k
+    real(rt) :: err(3)
+
+    max_err  = 0.d0
+    mean_err = 0.d0
+
+    do k = lo(3),hi(3)
+        do j = lo(2),hi(2)
+            do i = lo(1),hi(1)
+                err(1) = rel_err(state(i,j,k,UEINT)/state(i,j,k,URHO), ref(i,j,k,UEINT)/ref(i,j,k,URHO))
+                err(2) = rel_err(diag_eos(i,j,k,TEMP_COMP), ref_eos(i,j,k,TEMP_COMP))
+                err(3) = rel_err(diag_eos(i,j,k,  NE_COMP), ref_eos(i,j,k,  NE_COMP))
+                max_err  = max(max_err, err)
+                mean_err = mean_err + err
+            end do
+        end do
+    end do
+
+    mean_err = mean_err / dble((hi(1)-lo(1)+1)*(hi(2)-lo(2)+1)*(hi(3)-lo(3)+1))
+
+contains
+
+    real(rt) function rel_err(x, x_ref)
+      real(rt), intent(in) :: x, x_ref
+      rel_err = abs(x - x_ref) / max(abs(x_ref), tiny(x_ref))
+    end function rel_err
+
+end subroutine fort_hc_bench_compare
@@ -1,4 +1,13 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "DarkMatterParticleContainer.H"
+#include "Nyx_exchange.H"
 
 using namespace amrex;
 
@@ -31,120 +40,130 @@ DarkMatterParticleContainer::InitCosmo1ppcMultiLevel(
 
     particles.resize(nlevs);
 
-    ParticleType p;
-    Real         disp[BL_SPACEDIM];
-    Real         vel[BL_SPACEDIM];
-    
-    Real 	mean_disp[BL_SPACEDIM]={D_DECL(0,0,0)};
+    //
+    // Particles that land in grids owned by other ranks, to be sent there.
+    //
+    Array<Array<char> > sends(ParallelDescriptor::NProcs());
+
+    //
+    // The tiles of mf, in a fixed order, and the particles made in each.
+    //
+    Array<int> tile_grid;
+    Array<Box> tile_box;
+    for (MFIter mfi(mf,true); mfi.isValid(); ++mfi)
+    {
+        tile_grid.push_back(mfi.index());
+        tile_box.push_back(mfi.tilebox());
+    }
+
+    const int ntiles = tile_box.size();
 
+    Array<Array<ParticleType> >    ps(ntiles);
+    Array<Array<ParticleLocData> > plds(ntiles);
 
     //
     // The mf should be initialized according to the ics...
     //
-    int outside_counter=0;
-    long outcount[3]={0,0,0};
-    long outcountminus[3]={0,0,0};
-    long totalcount=0;
-    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < ntiles; t++)
     {
-        FArrayBox&  myFab  = mf[mfi];
-	const Box&  vbx    = mfi.validbox();
-        const int  *fab_lo = vbx.loVect();
-        const int  *fab_hi = vbx.hiVect();
+        const FArrayBox& myFab  = mf[tile_grid[t]];
+        const Box&       tbx    = tile_box[t];
+        const int*       fab_lo = tbx.loVect();
+        const int*       fab_hi = tbx.hiVect();
+
+        ParticleType    p;
         ParticleLocData pld;
+
+        ps[t].reserve(tbx.numPts());
+        plds[t].reserve(tbx.numPts());
+
         for (int kx = fab_lo[2]; kx <= fab_hi[2]; kx++)
         {
             for (int jx = fab_lo[1]; jx <= fab_hi[1]; jx++)
             {
                 for (int ix = fab_lo[0]; ix <= fab_hi[0]; ix++)
                 {
-            	    IntVect indices(D_DECL(ix, jx, kx));
-		    totalcount++;
-		    if (baWhereNot.contains(indices)) 
-		    {
-                       continue;
-		    }
+                    IntVect indices(D_DECL(ix, jx, kx));
 
-	            for (int n = 0; n < BL_SPACEDIM; n++)
-	            {
-                        disp[n] = myFab(indices,disp_idx+n);
+                    if (baWhereNot.contains(indices))
+                        continue;
+
+                    for (int n = 0; n < BL_SPACEDIM; n++)
+                    {
                         //
-			// Start with homogeneous distribution (for 1 p per cell in the center of the cell),
-			//
-	                p.pos(n) = geom.ProbLo(n) + 
-                            (indices[n]+Real(0.5))*dx[n];
-			if(disp[n]*disp_fac[n]>dx[n]/2.0)
-			  outcount[n]++;
-			if(disp[n]*disp_fac[n]<-dx[n]/2.0)
-			  outcountminus[n]++;
-			mean_disp[n]+=fabs(disp[n]);
-			//
+                        // Start with homogeneous distribution (for 1 p per cell in the center of the cell),
                         // then add the displacement (input values weighted by domain length).
                         //
-	                p.pos(n) += disp[n] * disp_fac[n];
-
+                        p.pos(n) = geom.ProbLo(n) + 
+                            (indices[n]+Real(0.5))*dx[n] +
+                            myFab(indices,disp_idx+n) * disp_fac[n];
                         //
-			// Set the velocities.
+                        // Set the velocities.
                         //
-                        vel[n] = myFab(indices,vel_idx+n);
-	                p.rdata(n+1) = vel[n] * vel_fac[n];
-	            }
+                        p.rdata(n+1) = myFab(indices,vel_idx+n) * vel_fac[n];
+                    }
                     //
-		    // Set the mass of the particle from the input value.
+                    // Set the mass of the particle from the input value.
+                    // The ids are set by AddInitParticles.
                     //
-	            p.rdata(0)  = particleMass;
-	            p.id()      = ParticleType::NextID();
-	            p.cpu()     = MyProc;
-	
-	            if (!this->Where(p, pld))
+                    p.rdata(0)  = particleMass;
+                    p.cpu()     = MyProc;
+
+                    if (!this->Where(p, pld))
                     {
-      		        this->PeriodicShift(p);
+                        this->PeriodicShift(p);
 
                         if (!this->Where(p, pld))
                             amrex::Abort("ParticleContainer<N>::InitCosmo1ppcMultiLevel():invalid particle");
                     }
 
-		    BL_ASSERT(pld.m_lev >= 0 && pld.m_lev <= m_gdb->finestLevel());
-		    //handle particles that ran out of this level into a finer one. 
-		    if (baWhereNot.contains(pld.m_cell))
-		    {
-		      outside_counter++;
-		      ParticleType newp[8];
-                      ParticleLocData new_pld;
-		      for (int i=0;i<8;i++)
-		      {
-                          newp[i].rdata(0)   = particleMass/8.0;
-                          newp[i].id()       = ParticleType::NextID();
-                          newp[i].cpu()      = MyProc;
-                          for (int dim=0;dim<BL_SPACEDIM;dim++)
-                          {
-                              newp[i].pos(dim)=p.pos(dim)+(2*((i/(1 << dim)) % 2)-1)*dx[dim]/4.0;
-                              newp[i].rdata(dim+1)=p.rdata(dim+1);
-                          }
-                          
-                          if (!this->Where(newp[i], new_pld))
-                          {
-                              this->PeriodicShift(newp[i]);
-                              
-                              if (!this->Where(newp[i], new_pld))
-                                  amrex::Abort("ParticleContainer<N>::InitCosmo1ppcMultiLevel():invalid particle");
-                          }
-                          particles[new_pld.m_lev][std::make_pair(new_pld.m_grid, 
-                                                                  new_pld.m_tile)].push_back(newp[i]);
-		      }
-		      
-		    }
-	            
-	            //
-	            // Add it to the appropriate PBox at the appropriate level.
-	            //
-		    else
-                        particles[pld.m_lev][std::make_pair(pld.m_grid, pld.m_tile)].push_back(p);
+                    BL_ASSERT(pld.m_lev >= 0 && pld.m_lev <= m_gdb->finestLevel());
+                    //
+                    // Handle particles that ran out of this level into a finer one. 
+                    //
+                    if (baWhereNot.contains(pld.m_cell))
+                    {
+                        ParticleType    newp;
+                        ParticleLocData new_pld;
+                        for (int i = 0; i < 8; i++)
+                        {
+                            newp.rdata(0) = particleMass/8.0;
+                            newp.cpu()    = MyProc;
+                            for (int dim = 0; dim < BL_SPACEDIM; dim++)
+                            {
+                                newp.pos(dim)     = p.pos(dim)+(2*((i/(1 << dim)) % 2)-1)*dx[dim]/4.0;
+                                newp.rdata(dim+1) = p.rdata(dim+1);
+                            }
+
+                            if (!this->Where(newp, new_pld))
+                            {
+                                this->PeriodicShift(newp);
+
+                                if (!this->Where(newp, new_pld))
+                                    amrex::Abort("ParticleContainer<N>::InitCosmo1ppcMultiLevel():invalid particle");
+                            }
+                            ps[t].push_back(newp);
+                            plds[t].push_back(new_pld);
+                        }
+                    }
+                    else
+                    {
+                        ps[t].push_back(p);
+                        plds[t].push_back(pld);
+                    }
                 }
             }
         }
     }
-    Redistribute();
+
+    AddInitParticles(ps, plds, sends);
+
+    ExchangeInitParticles(sends);
+
+    DetectUniformMass();
 }
 
 void
@@ -166,21 +185,46 @@ DarkMatterParticleContainer::InitCosmo1ppc(MultiFab& mf, const Real vel_fac[], c
         BL_ASSERT(particles[lev].empty());
     }
 
-    ParticleType      p;
-    ParticleLocData   pld;
-    Real              disp[BL_SPACEDIM];
     const Real        len[BL_SPACEDIM] = { D_DECL(geom.ProbLength(0),
                                                   geom.ProbLength(1),
                                                   geom.ProbLength(2)) };
+
+    Array<Array<char> > sends(ParallelDescriptor::NProcs());
+
+    //
+    // The tiles of mf, in a fixed order, and the particles made in each.
+    //
+    Array<int> tile_grid;
+    Array<Box> tile_box;
+    for (MFIter mfi(mf,true); mfi.isValid(); ++mfi)
+    {
+        tile_grid.push_back(mfi.index());
+        tile_box.push_back(mfi.tilebox());
+    }
+
+    const int ntiles = tile_box.size();
+
+    Array<Array<ParticleType> >    ps(ntiles);
+    Array<Array<ParticleLocData> > plds(ntiles);
+
     //
     // The grid should be initialized according to the ics...
     //
-    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < ntiles; t++)
     {
-        FArrayBox&  myFab  = mf[mfi];
-	const Box&  vbx    = mfi.validbox();
-        const int  *fab_lo = vbx.loVect();
-        const int  *fab_hi = vbx.hiVect();
+        const FArrayBox& myFab  = mf[tile_grid[t]];
+        const Box&       tbx    = tile_box[t];
+        const int*       fab_lo = tbx.loVect();
+        const int*       fab_hi = tbx.hiVect();
+
+        ParticleType    p;
+        ParticleLocData pld;
+
+        ps[t].reserve(tbx.numPts());
+        plds[t].reserve(tbx.numPts());
 
         for (int kx = fab_lo[2]; kx <= fab_hi[2]; kx++)
         {
@@ -188,47 +232,191 @@ DarkMatterParticleContainer::InitCosmo1ppc(MultiFab& mf, const Real vel_fac[], c
             {
                 for (int ix = fab_lo[0]; ix <= fab_hi[0]; ix++)
                 {
-            	    IntVect indices(D_DECL(ix, jx, kx));
+                    IntVect indices(D_DECL(ix, jx, kx));
 
-	            for (int n = 0; n < BL_SPACEDIM; n++)
-	            {
-                        disp[n] = myFab(indices,n);
+                    for (int n = 0; n < BL_SPACEDIM; n++)
+                    {
+                        const Real disp = myFab(indices,n);
                         //
-			// Start with homogeneous distribution (for 1 p per cell in the center of the cell),
+                        // Start with homogeneous distribution (for 1 p per cell in the center of the cell),
                         // then add the displacement (input values weighted by domain length).
                         //
-	                p.pos(n) = geom.ProbLo(n) + 
+                        p.pos(n) = geom.ProbLo(n) + 
                             (indices[n]+Real(0.5))*dx[n] +
-                            disp[n] * len[n];
+                            disp * len[n];
                         //
-			// Set the velocities.
+                        // Set the velocities.
                         //
-	                p.rdata(n+1) = disp[n] * vel_fac[n];
-	            }
+                        p.rdata(n+1) = disp * vel_fac[n];
+                    }
                     //
-		    // Set the mass of the particle from the input value.
+                    // Set the mass of the particle from the input value.
                     //
-	            p.rdata(0)  = particleMass;
-	            p.id()      = ParticleType::NextID();
-	            p.cpu()     = MyProc;
-	
-	            if (!this->Where(p, pld))
+                    p.rdata(0)  = particleMass;
+                    p.cpu()     = MyProc;
+
+                    if (!this->Where(p, pld))
                     {
-      		        this->PeriodicShift(p);
-                        
+                        this->PeriodicShift(p);
+
                         if (!this->Where(p, pld))
                             amrex::Abort("ParticleContainer<N>::InitCosmo1ppc(): invalid particle");
-		    }
+                    }
 
-	            BL_ASSERT(pld.m_lev >= 0 && pld.m_lev <= this->finestLevel());
-	            //
-	            // Add it to the appropriate PBox at the appropriate level.
-	            //
-	            particles[pld.m_lev][std::make_pair(pld.m_grid, pld.m_tile)].push_back(p);
+                    BL_ASSERT(pld.m_lev >= 0 && pld.m_lev <= this->finestLevel());
+
+                    ps[t].push_back(p);
+                    plds[t].push_back(pld);
                 }
             }
         }
     }
+
+    AddInitParticles(ps, plds, sends);
+
+    ExchangeInitParticles(sends);
+
+    DetectUniformMass();
+}
+
+void
+DarkMatterParticleContainer::AddInitParticles (Array<Array<ParticleType> >&          ps,
+                                               const Array<Array<ParticleLocData> >& plds,
+                                               Array<Array<char> >&                  sends)
+{
+    BL_PROFILE("DarkMatterParticleContainer::AddInitParticles()");
+
+    typedef std::pair<int, std::pair<int,int> > TileKey;  // (level, (grid, tile))
+
+    const int MyProc = ParallelDescriptor::MyProc();
+    const int ntiles = ps.size();
+
+    //
+    // Number the particles by the order of the tiles they were made in, then
+    // by their order in that tile, from one block of ids for the rank.
+    //
+    Array<long> first(ntiles+1, 0);
+    for (int t = 0; t < ntiles; t++)
+        first[t+1] = first[t] + ps[t].size();
+
+    BL_ASSERT(first[ntiles] < std::numeric_limits<int>::max() - ParticleType::NextID());
+
+    const int id0 = ParticleType::NextID();
+    ParticleType::NextID(id0 + first[ntiles]);
+
+    //
+    // How many particles each tile sends to each of our tiles.
+    //
+    Array<std::map<TileKey, long> > counts(ntiles);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < ntiles; t++)
+    {
+        for (int i = 0; i < ps[t].size(); i++)
+        {
+            const ParticleLocData& pld = plds[t][i];
+
+            ps[t][i].id() = id0 + first[t] + i;
+
+            if (m_gdb->ParticleDistributionMap(pld.m_lev)[pld.m_grid] == MyProc)
+                counts[t][std::make_pair(pld.m_lev, std::make_pair(pld.m_grid, pld.m_tile))]++;
+        }
+    }
+
+    //
+    // Make room in our tiles for all of them at once, and give each tile
+    // its own stretch of each one, so they can be filled without a lock.
+    //
+    std::map<TileKey, long> total;
+    for (int t = 0; t < ntiles; t++)
+        for (const auto& kv : counts[t])
+            total[kv.first] += kv.second;
+
+    std::map<TileKey, ParticleType*> base;
+    for (const auto& kv : total)
+    {
+        const int lev = kv.first.first;
+        AoS& pbox = this->GetParticles(lev)[kv.first.second].GetArrayOfStructs();
+        const long n = pbox.size();
+        pbox().resize(n + kv.second);
+        base[kv.first] = pbox().data() + n;
+    }
+
+    Array<std::map<TileKey, ParticleType*> > dst(ntiles);
+    for (int t = 0; t < ntiles; t++)
+    {
+        for (const auto& kv : counts[t])
+        {
+            ParticleType*& b = base[kv.first];
+            dst[t][kv.first] = b;
+            b += kv.second;
+        }
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < ntiles; t++)
+    {
+        std::map<TileKey, ParticleType*>& d = dst[t];
+
+        for (int i = 0; i < ps[t].size(); i++)
+        {
+            const ParticleLocData& pld = plds[t][i];
+
+            if (m_gdb->ParticleDistributionMap(pld.m_lev)[pld.m_grid] == MyProc)
+                *d[std::make_pair(pld.m_lev, std::make_pair(pld.m_grid, pld.m_tile))]++ = ps[t][i];
+        }
+    }
+
+    //
+    // The rest go to their owners, in the same order.
+    //
+    for (int t = 0; t < ntiles; t++)
+    {
+        for (int i = 0; i < ps[t].size(); i++)
+        {
+            const ParticleLocData& pld = plds[t][i];
+            const int              who = m_gdb->ParticleDistributionMap(pld.m_lev)[pld.m_grid];
+
+            if (who != MyProc)
+            {
+                const char* c = reinterpret_cast<const char*>(&ps[t][i]);
+                sends[who].insert(sends[who].end(), c, c + sizeof(ParticleType));
+            }
+        }
+
+        Array<ParticleType>().swap(ps[t]);
+    }
+}
+
+void
+DarkMatterParticleContainer::ExchangeInitParticles (Array<Array<char> >& sends)
+{
+    BL_PROFILE("DarkMatterParticleContainer::ExchangeInitParticles()");
+
+    Array<char> recvdata;
+    SparseExchange(sends, recvdata);
+
+    //
+    // The senders have already shifted the particles into the domain.
+    //
+    const std::size_t np = recvdata.size() / sizeof(ParticleType);
+    ParticleType      p;
+    ParticleLocData   pld;
+
+    for (std::size_t i = 0; i < np; i++)
+    {
+        std::memcpy(&p, &recvdata[i*sizeof(ParticleType)], sizeof(ParticleType));
+
+        if (!this->Where(p, pld))
+            amrex::Abort("DarkMatterParticleContainer::ExchangeInitParticles(): invalid particle");
+
+        AoS& pbox = this->GetParticles(pld.m_lev)[std::make_pair(pld.m_grid, pld.m_tile)].GetArrayOfStructs();
+        pbox.push_back(p);
+    }
 }
 
 void
@@ -466,3 +654,1216 @@ DarkMatterParticleContainer::AssignDensityAndVels (Array<std::unique_ptr<MultiFa
 {
     AssignDensity(mf, lev_min, BL_SPACEDIM+1);
 }
+
+void
+DarkMatterParticleContainer::DetectUniformMass ()
+{
+    BL_PROFILE("DarkMatterParticleContainer::DetectUniformMass()");
+
+    Real mmin =  std::numeric_limits<Real>::max();
+    Real mmax = -std::numeric_limits<Real>::max();
+
+    for (int lev = 0; lev < this->GetParticles().size(); lev++)
+    {
+        const ParticleLevel& pmap = this->GetParticles(lev);
+
+        for (auto& kv : pmap)
+        {
+            const AoS& pbox = kv.second.GetArrayOfStructs();
+            const int  n    = pbox.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min:mmin) reduction(max:mmax)
+#endif
+            for (int i = 0; i < n; i++)
+            {
+                const ParticleType& p = pbox[i];
+
+                if (p.id() <= 0) continue;
+
+                mmin = std::min(mmin, p.rdata(0));
+                mmax = std::max(mmax, p.rdata(0));
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceRealMin(mmin);
+    ParallelDescriptor::ReduceRealMax(mmax);
+
+    uniform_mass = (mmin == mmax && mmin > 0) ? mmin : 0;
+
+    if (m_verbose && ParallelDescriptor::IOProcessor() && uniform_mass > 0)
+    {
+        std::cout << "DarkMatterParticleContainer: all particles have mass " << uniform_mass << '\n';
+    }
+}
+
+Real
+DarkMatterParticleContainer::sumParticleMass (int level) const
+{
+    if (uniform_mass == 0)
+        return NyxParticleContainer<1+BL_SPACEDIM>::sumParticleMass(level);
+
+    BL_PROFILE("DarkMatterParticleContainer::sumParticleMass()");
+
+    return uniform_mass * NumberOfParticlesAtLevel(level);
+}
+
+void
+DarkMatterParticleContainer::sumParticleMomentum (int lev, Real* mom) const
+{
+    if (uniform_mass == 0)
+    {
+        NyxParticleContainer<1+BL_SPACEDIM>::sumParticleMomentum(lev, mom);
+        return;
+    }
+
+    BL_PROFILE("DarkMatterParticleContainer::sumParticleMomentum()");
+    BL_ASSERT(lev >= 0 && lev < this->GetParticles().size());
+
+    const ParticleLevel& pmap = this->GetParticles(lev);
+
+    D_TERM(mom[0] = 0;, mom[1] = 0;, mom[2] = 0;);
+
+    for (auto& kv : pmap)
+    {
+        const AoS& pbox = kv.second.GetArrayOfStructs();
+        const int  n    = pbox.size();
+
+        Real vel_0 = 0, vel_1 = 0, vel_2 = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:vel_0,vel_1,vel_2)
+#endif
+        for (int i = 0; i < n; i++)
+        {
+            const ParticleType& p = pbox[i];
+
+            if (p.id() > 0)
+            {
+                D_TERM(vel_0 += p.rdata(1);,
+                       vel_1 += p.rdata(2);,
+                       vel_2 += p.rdata(3););
+            }
+        }
+
+        D_TERM(mom[0] += vel_0;, mom[1] += vel_1;, mom[2] += vel_2;);
+    }
+
+    ParallelDescriptor::ReduceRealSum(mom,BL_SPACEDIM);
+
+    D_TERM(mom[0] *= uniform_mass;, mom[1] *= uniform_mass;, mom[2] *= uniform_mass;);
+}
+
+void
+DarkMatterParticleContainer::MultiplyParticleMass (int lev, Real mult)
+{
+    BL_PROFILE("DarkMatterParticleContainer::MultiplyParticleMass()");
+    BL_ASSERT(lev == 0);
+
+    //
+    // The masses at other levels are left as they are, so they only stay
+    // the same as these if there are no particles there.
+    //
+    for (int l = 0; l < this->GetParticles().size() && uniform_mass > 0; l++)
+    {
+        if (l != lev && NumberOfParticlesAtLevel(l) > 0)
+            uniform_mass = 0;
+    }
+
+    if (uniform_mass == 0)
+    {
+        NyxParticleContainer<1+BL_SPACEDIM>::MultiplyParticleMass(lev, mult);
+        return;
+    }
+
+    uniform_mass *= mult;
+
+    ParticleLevel& pmap = this->GetParticles(lev);
+
+    for (auto& kv : pmap)
+    {
+        AoS&      pbox = kv.second.GetArrayOfStructs();
+        const int n    = pbox.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < n; i++)
+        {
+            ParticleType& p = pbox[i];
+
+            if (p.id() > 0)
+                p.rdata(0) = uniform_mass;
+        }
+    }
+}
+
+void
+DarkMatterParticleContainer::AssignDensitySingleLevel (MultiFab& mf, int lev, int ncomp,
+                                                       int particle_lvl_offset) const
+{
+    const Geometry& geom = m_gdb->Geom(lev);
+
+    if (uniform_mass == 0 || ncomp != 1 || particle_lvl_offset != 0 ||
+        !geom.isAllPeriodic() || BL_SPACEDIM != 3)
+    {
+        NyxParticleContainer<1+BL_SPACEDIM>::AssignDensitySingleLevel(mf, lev, ncomp, particle_lvl_offset);
+        return;
+    }
+
+#if (BL_SPACEDIM == 3)
+    BL_PROFILE("DarkMatterParticleContainer::AssignDensitySingleLevel()");
+
+    const Real strttime = ParallelDescriptor::second();
+
+    //
+    // Deposit into mf itself if it is on the particle grids and has the
+    // ghost cell that CIC needs, and into a copy on the particle grids if not.
+    //
+    std::unique_ptr<MultiFab> tmp;
+
+    MultiFab* mf_pointer = &mf;
+
+    if (!OnSameGrids(lev, mf) || mf.nGrow() < 1)
+    {
+        tmp.reset(new MultiFab(m_gdb->ParticleBoxArray(lev),
+                               m_gdb->ParticleDistributionMap(lev),
+                               1, 1));
+        mf_pointer = tmp.get();
+    }
+
+    mf_pointer->setVal(0);
+
+    const Real* plo = geom.ProbLo();
+    const Real* dxi = geom.InvCellSize();
+    const Real* dx  = geom.CellSize();
+    const Real  fac = uniform_mass / (dx[0]*dx[1]*dx[2]);
+
+    const ParticleLevel& pmap = this->GetParticles(lev);
+
+    Array<int>        grids;
+    Array<const AoS*> pboxes;
+
+    for (auto& kv : pmap)
+    {
+        if (kv.second.GetArrayOfStructs().size() == 0) continue;
+
+        grids.push_back(kv.first.first);
+        pboxes.push_back(&kv.second.GetArrayOfStructs());
+    }
+
+    const int ntiles = grids.size();
+
+    //
+    // Each tile is deposited into a FAB around its own particles, where the
+    // CIC weights are summed without the mass.  Only the scaled sums are
+    // added to the grid, which the tiles of one grid take turns at.
+    //
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int t = 0; t < ntiles; t++)
+    {
+        const AoS& pbox = *pboxes[t];
+        const int  n    = pbox.size();
+
+        //
+        // The cells (i-1,j-1,k-1) to (i,j,k) around each particle.
+        //
+        const int big = std::numeric_limits<int>::max();
+
+        IntVect lo( big,  big,  big);
+        IntVect hi(-big, -big, -big);
+
+        for (int i = 0; i < n; i++)
+        {
+            const ParticleType& p = pbox[i];
+
+            if (p.id() <= 0) continue;
+
+            for (int d = 0; d < 3; d++)
+            {
+                const int c = static_cast<int>(std::floor((p.pos(d) - plo[d]) * dxi[d] + 0.5));
+                lo[d] = std::min(lo[d], c - 1);
+                hi[d] = std::max(hi[d], c);
+            }
+        }
+
+        if (lo[0] > hi[0]) continue;
+
+        const Box bx(lo, hi);
+
+        FArrayBox cnt(bx, 1);
+        cnt.setVal(0);
+
+        Real*      c  = cnt.dataPtr();
+        const long sy = bx.length(0);
+        const long sz = sy * bx.length(1);
+
+        for (int i = 0; i < n; i++)
+        {
+            const ParticleType& p = pbox[i];
+
+            if (p.id() <= 0) continue;
+
+            const Real lx = (p.pos(0) - plo[0]) * dxi[0] + 0.5;
+            const Real ly = (p.pos(1) - plo[1]) * dxi[1] + 0.5;
+            const Real lz = (p.pos(2) - plo[2]) * dxi[2] + 0.5;
+
+            const int ix = static_cast<int>(std::floor(lx));
+            const int iy = static_cast<int>(std::floor(ly));
+            const int iz = static_cast<int>(std::floor(lz));
+
+            const Real wx1 = lx - ix, wx0 = 1 - wx1;
+            const Real wy1 = ly - iy, wy0 = 1 - wy1;
+            const Real wz1 = lz - iz, wz0 = 1 - wz1;
+
+            Real* q = c + (ix-1-lo[0]) + (iy-1-lo[1])*sy + (iz-1-lo[2])*sz;
+
+            q[0]       += wx0*wy0*wz0;
+            q[1]       += wx1*wy0*wz0;
+            q[sy]      += wx0*wy1*wz0;
+            q[sy+1]    += wx1*wy1*wz0;
+            q[sz]      += wx0*wy0*wz1;
+            q[sz+1]    += wx1*wy0*wz1;
+            q[sz+sy]   += wx0*wy1*wz1;
+            q[sz+sy+1] += wx1*wy1*wz1;
+        }
+
+        cnt.mult(fac);
+
+        FArrayBox& fab = (*mf_pointer)[grids[t]];
+        //
+        // As in the general deposit, weight that falls outside the grid and
+        // its ghost cells is dropped.
+        //
+        const Box ovlp = bx & fab.box();
+
+#ifdef _OPENMP
+#pragma omp critical(nyx_uniform_deposit_lock)
+#endif
+        if (ovlp.ok())
+            fab.plus(cnt, ovlp, 0, 0, 1);
+    }
+
+    mf_pointer->SumBoundary(geom.periodicity());
+
+    if (mf_pointer != &mf)
+        mf.copy(*mf_pointer, 0, 0, 1);
+
+    if (m_verbose > 1)
+    {
+        Real stoptime = ParallelDescriptor::second() - strttime;
+
+        ParallelDescriptor::ReduceRealMax(stoptime,ParallelDescriptor::IOProcessorNumber());
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            std::cout << "DarkMatterParticleContainer::AssignDensitySingleLevel (uniform mass) time: "
+                      << stoptime << '\n';
+        }
+    }
+#endif
+}
+
+void
+DarkMatterParticleContainer::AggregateVirtualParticles (AoS& virts, int lev) const
+{
+    BL_PROFILE("DarkMatterParticleContainer::AggregateVirtualParticles()");
+
+    const int  n      = virts.size();
+    const Box& domain = m_gdb->Geom(lev).Domain();
+
+    //
+    // The merged particles are written over the front of virts in the order
+    // their cells are first seen, accumulating m, m x and m v, so the one
+    // for a cell is never ahead of the particles still to be read.
+    //
+    std::unordered_map<long,int> slot;
+    slot.reserve(n);
+
+    Array<Real> mx(n*BL_SPACEDIM);
+    int nout = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        const ParticleType p = virts[i];
+
+        if (p.id() <= 0) continue;
+
+        const Real m    = p.rdata(0);
+        const long cell = domain.index(this->Index(p, lev));
+
+        auto it = slot.find(cell);
+
+        if (it == slot.end())
+        {
+            const int j = nout++;
+            slot[cell] = j;
+
+            ParticleType& q = virts[j];
+            q = p;
+            for (int d = 0; d < BL_SPACEDIM; d++)
+            {
+                mx[j*BL_SPACEDIM+d] = m * p.pos(d);
+                q.rdata(d+1)        = m * p.rdata(d+1);
+            }
+        }
+        else
+        {
+            const int     j = it->second;
+            ParticleType& q = virts[j];
+
+            q.rdata(0) += m;
+            for (int d = 0; d < BL_SPACEDIM; d++)
+            {
+                mx[j*BL_SPACEDIM+d] += m * p.pos(d);
+                q.rdata(d+1)        += m * p.rdata(d+1);
+            }
+        }
+    }
+
+    for (int j = 0; j < nout; j++)
+    {
+        ParticleType& q    = virts[j];
+        const Real    minv = (q.rdata(0) > 0) ? 1.0 / q.rdata(0) : 0.0;
+
+        if (minv == 0) continue;
+
+        for (int d = 0; d < BL_SPACEDIM; d++)
+        {
+            q.pos(d)     = mx[j*BL_SPACEDIM+d] * minv;
+            q.rdata(d+1) *= minv;
+        }
+    }
+
+    virts().resize(nout);
+
+    if (m_verbose > 1)
+    {
+        long counts[2] = { n, nout };
+        ParallelDescriptor::ReduceLongSum(counts, 2, ParallelDescriptor::IOProcessorNumber());
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "DarkMatterParticleContainer::AggregateVirtualParticles(): "
+                      << counts[0] << " virtual particles merged into " << counts[1]
+                      << " at level " << lev << '\n';
+    }
+}
+
+namespace
+{
+    //
+    // A particle's (cpu, id).  Its persistent ghosts keep the id and store
+    // the cpu as -cpu-1, which marks them as ghosts.
+    //
+    inline long ghost_key (int cpu, int id)
+    {
+        return (static_cast<long>(cpu) << 32) | static_cast<unsigned int>(id);
+    }
+
+    //
+    // The rank that decides what happens to the ghost of a key.
+    //
+    inline int ghost_rendezvous (long key, int nprocs)
+    {
+        return static_cast<int>(static_cast<unsigned long>(key) % nprocs);
+    }
+}
+
+void
+DarkMatterParticleContainer::UpdateGhostParticles (int                           lev,
+                                                   int                           nGrow,
+                                                   DarkMatterParticleContainer&  ghostpc,
+                                                   std::unordered_set<long>&     ghosted)
+{
+    BL_PROFILE("DarkMatterParticleContainer::UpdateGhostParticles()");
+
+    const BoxArray& fine = m_gdb->ParticleBoxArray(lev+1);
+    std::vector< std::pair<int,Box> > isects;
+
+    //
+    // The band is the fine grids grown by nGrow fine cells.
+    //
+    auto in_band = [&] (const ParticleType& p) -> bool
+    {
+        const IntVect iv = this->Index(p, lev+1);
+        fine.intersections(Box(iv,iv), isects, true, nGrow);
+        return !isects.empty();
+    };
+
+    //
+    // What each rank knows about a key: its parent is new to the band here
+    // (it may only have come from another rank, with its ghost still there),
+    // left the band, is no longer here, or stayed in the band; or its ghost
+    // is held here, or drifted out of the band.
+    //
+    enum { New = 0, Left, Gone, Kept, Held, Lost, NLists };
+    Array<long>              mine[NLists];
+
+    Array<ParticleType>      cands;
+    std::unordered_set<long> present;
+
+    if (lev < this->GetParticles().size())
+    {
+        for (auto& kv : this->GetParticles(lev))
+        {
+            const AoS& pbox = kv.second.GetArrayOfStructs();
+            const int  n    = pbox.size();
+
+            for (int i = 0; i < n; i++)
+            {
+                const ParticleType& p = pbox[i];
+
+                if (p.id() <= 0) continue;
+
+                const long key  = ghost_key(p.cpu(), p.id());
+                const bool band = in_band(p);
+                const bool had  = ghosted.count(key) > 0;
+
+                present.insert(key);
+
+                if (band && !had)
+                {
+                    mine[New].push_back(key);
+                    cands.push_back(p);
+                }
+                else if (!band && had)
+                {
+                    mine[Left].push_back(key);
+                    ghosted.erase(key);
+                }
+                else if (band)
+                {
+                    mine[Kept].push_back(key);
+                }
+            }
+        }
+    }
+
+    for (auto it = ghosted.begin(); it != ghosted.end(); )
+    {
+        if (present.count(*it) == 0)
+        {
+            mine[Gone].push_back(*it);
+            it = ghosted.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    //
+    // Ghosts that moveKickDrift dropped for leaving the grown grids have had
+    // their id negated.
+    //
+    Array<ParticleLevel>& gparticles = ghostpc.GetParticles();
+
+    if (lev+1 < gparticles.size())
+    {
+        for (auto& kv : gparticles[lev+1])
+        {
+            AoS&      gbox = kv.second.GetArrayOfStructs();
+            const int n    = gbox.size();
+
+            for (int i = 0; i < n; i++)
+            {
+                ParticleType& g = gbox[i];
+
+                if (g.cpu() >= 0 || g.id() == 0) continue;
+
+                if (g.id() < 0)
+                {
+                    mine[Lost].push_back(ghost_key(-g.cpu()-1, -g.id()));
+                }
+                else if (!in_band(g))
+                {
+                    mine[Lost].push_back(ghost_key(-g.cpu()-1, g.id()));
+                    g.id() = -g.id();
+                }
+                else
+                {
+                    mine[Held].push_back(ghost_key(-g.cpu()-1, g.id()));
+                }
+            }
+        }
+    }
+
+    //
+    // Everything known about a key goes to its rendezvous rank as (key,
+    // list, rank), and the rendezvous rank answers the ranks that have to
+    // act with (key, list): make a ghost for a New or Kept parent, or drop
+    // a Held ghost.  Only the ranks with ghosts or band parents take part.
+    //
+    const int NProcs = ParallelDescriptor::NProcs();
+    const int MyProc = ParallelDescriptor::MyProc();
+
+    Array<Array<long> > sends(NProcs);
+
+    for (int l = 0; l < NLists; l++)
+    {
+        for (int i = 0; i < mine[l].size(); i++)
+        {
+            Array<long>& snd = sends[ghost_rendezvous(mine[l][i], NProcs)];
+            snd.push_back(mine[l][i]);
+            snd.push_back(l);
+            snd.push_back(MyProc);
+        }
+    }
+
+    Array<long> asked;
+    SparseExchange(sends, asked);
+
+    std::unordered_map<long, int> seen;
+    for (int i = 0; i < asked.size(); i += 3)
+        seen[asked[i]] |= 1 << asked[i+1];
+
+    Array<Array<long> > replies(NProcs);
+
+    for (int i = 0; i < asked.size(); i += 3)
+    {
+        const long key = asked[i];
+        const int  l   = asked[i+1];
+        const int  m   = seen[key];
+
+        const bool gone = (m & (1 << Gone)) && !(m & (1 << New));
+
+        // A parent new here needs a ghost unless it only changed rank and its
+        // ghost is still there; one that stayed needs one if its ghost drifted
+        // out of the band.  A ghost goes if its parent left the band or the level.
+        if ((l == New  && (!(m & (1 << Gone)) || (m & (1 << Lost)))) ||
+            (l == Kept && (m & (1 << Lost))) ||
+            (l == Held && ((m & (1 << Left)) || gone)))
+        {
+            replies[asked[i+2]].push_back(key);
+            replies[asked[i+2]].push_back(l);
+        }
+    }
+
+    Array<long> answers;
+    SparseExchange(replies, answers);
+
+    std::unordered_set<long> act[NLists];
+    for (int i = 0; i < answers.size(); i += 2)
+        act[answers[i+1]].insert(answers[i]);
+
+    AoS ghosts;
+
+    for (int i = 0; i < cands.size(); i++)
+    {
+        const long key = ghost_key(cands[i].cpu(), cands[i].id());
+
+        ghosted.insert(key);
+
+        if (act[New].count(key) > 0)
+        {
+            ghosts.push_back(cands[i]);
+            ghosts[ghosts.size()-1].cpu() = -cands[i].cpu()-1;
+        }
+    }
+
+    if (!act[Kept].empty() && lev < this->GetParticles().size())
+    {
+        for (auto& kv : this->GetParticles(lev))
+        {
+            const AoS& pbox = kv.second.GetArrayOfStructs();
+            const int  n    = pbox.size();
+
+            for (int i = 0; i < n; i++)
+            {
+                const ParticleType& p   = pbox[i];
+                const long          key = ghost_key(p.cpu(), p.id());
+
+                if (p.id() > 0 && act[Kept].count(key) > 0)
+                {
+                    ghosts.push_back(p);
+                    ghosts[ghosts.size()-1].cpu() = -p.cpu()-1;
+                }
+            }
+        }
+    }
+
+    //
+    // Drop the ghosts of parents that left the band or the level, and the
+    // ones that drifted out of it.
+    //
+    if (lev+1 < gparticles.size())
+    {
+        for (auto& kv : gparticles[lev+1])
+        {
+            AoS&      gbox = kv.second.GetArrayOfStructs();
+            const int n    = gbox.size();
+            int       nkeep = 0;
+
+            for (int i = 0; i < n; i++)
+            {
+                const ParticleType& g = gbox[i];
+
+                if (g.id() <= 0) continue;
+
+                if (act[Held].count(ghost_key(-g.cpu()-1, g.id())) > 0)
+                    continue;
+
+                gbox[nkeep++] = g;
+            }
+
+            gbox().resize(nkeep);
+        }
+    }
+
+    if (m_verbose > 1)
+    {
+        long counts[5] = { (long) mine[New].size(), (long) mine[Left].size(),
+                           (long) mine[Gone].size(), (long) mine[Lost].size(),
+                           (long) ghosts.size() };
+        ParallelDescriptor::ReduceLongSum(counts, 5, ParallelDescriptor::IOProcessorNumber());
+
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "DarkMatterParticleContainer::UpdateGhostParticles() at level " << lev
+                      << ": " << counts[0] << " entered, " << counts[1] << " left, "
+                      << counts[2] << " gone, " << counts[3] << " lost, "
+                      << counts[4] << " ghosts added" << '\n';
+    }
+
+    //
+    // This also moves the ghosts that drifted into other grids.
+    //
+    ghostpc.AddParticlesAtLevel(ghosts, lev+1, nGrow);
+}
+
+/*
+  Short-range force
+*/
+
+void
+DarkMatterParticleContainer::ShortRangeKick (int lev, Real fac, Real rs, Real rcut, Real eps)
+{
+    BL_PROFILE("DarkMatterParticleContainer::ShortRangeKick()");
+
+    if (lev >= this->GetParticles().size())
+        return;
+
+    const int       MyProc = ParallelDescriptor::MyProc();
+    const int       NProcs = ParallelDescriptor::NProcs();
+    const Geometry& geom   = m_gdb->Geom(lev);
+    const Real*     dx     = geom.CellSize();
+    const Real*     plo    = geom.ProbLo();
+    const BoxArray& ba     = m_gdb->ParticleBoxArray(lev);
+    const DistributionMapping& dmap = m_gdb->ParticleDistributionMap(lev);
+
+    ParticleLevel& pmap = this->GetParticles(lev);
+
+    //
+    // Sources are stored as (x, y, z, m).  A particle is also sent to every
+    // rank with a grid within rcut of it, plus one cell since the particles
+    // may have drifted out of their grids, once for each periodic image.
+    //
+    const int nr = 1 + BL_SPACEDIM;
+    Real dx_min = dx[0], dx_max = dx[0];
+    for (int d = 1; d < BL_SPACEDIM; d++)
+    {
+        dx_min = std::min(dx_min, dx[d]);
+        dx_max = std::max(dx_max, dx[d]);
+    }
+    const int ng = static_cast<int>(std::ceil(rcut / dx_min)) + 1;
+
+    Array<Real>           src;
+    Array<Array<Real> >   images(NProcs);
+    Array<IntVect>        pshifts;
+    std::vector< std::pair<int,Box> > isects;
+    std::vector< std::pair<int,IntVect> > sent;
+
+    for (auto& kv : pmap)
+    {
+        const Box& own  = ba[kv.first.first];
+        const AoS& pbox = kv.second.GetArrayOfStructs();
+        const int  n    = pbox.size();
+
+        for (int i = 0; i < n; i++)
+        {
+            const ParticleType& p = pbox[i];
+
+            if (p.id() <= 0) continue;
+
+            D_TERM(src.push_back(p.pos(0));,
+                   src.push_back(p.pos(1));,
+                   src.push_back(p.pos(2)););
+            src.push_back(p.rdata(0));
+
+            const IntVect iv   = this->Index(p, lev);
+            const Box     near = amrex::grow(Box(iv,iv), ng);
+
+            if (own.contains(near)) continue;
+
+            geom.periodicShift(geom.Domain(), near, pshifts);
+            pshifts.push_back(IntVect::TheZeroVector());
+
+            sent.clear();
+            for (int k = 0; k < pshifts.size(); k++)
+            {
+                const IntVect& s = pshifts[k];
+                ba.intersections(near + s, isects);
+
+                for (int j = 0; j < isects.size(); j++)
+                {
+                    const int who = dmap[isects[j].first];
+
+                    if (who == MyProc && s == IntVect::TheZeroVector()) continue;
+                    if (std::find(sent.begin(), sent.end(), std::make_pair(who,s)) != sent.end()) continue;
+                    sent.push_back(std::make_pair(who,s));
+
+                    Array<Real>& buf = images[who];
+                    D_TERM(buf.push_back(p.pos(0) + s[0]*dx[0]);,
+                           buf.push_back(p.pos(1) + s[1]*dx[1]);,
+                           buf.push_back(p.pos(2) + s[2]*dx[2]););
+                    buf.push_back(p.rdata(0));
+                }
+            }
+        }
+    }
+
+    // Receive straight onto the end of the local sources
+    SparseExchange(images, src);
+
+    //
+    // Bin the sources into cubes of side rcut, sorted by bin, so the partners
+    // of a particle are in the 27 bins around its own.  The bins are padded
+    // on each side for the images, which reach ng cells outside the domain.
+    //
+    const long nsrc  = src.size() / nr;
+    const Real hinv  = 1.0 / rcut;
+    const int  npad  = 2 + static_cast<int>(std::ceil(ng * dx_max * hinv));
+
+    long nbin[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; d++)
+        nbin[d] = static_cast<long>(std::ceil(geom.ProbLength(d) * hinv)) + 2*npad;
+
+    auto bin_of = [&] (const Real* x, int* ib)
+    {
+        for (int d = 0; d < BL_SPACEDIM; d++)
+            ib[d] = static_cast<int>(std::floor((x[d] - plo[d]) * hinv)) + npad;
+    };
+
+    auto key_of = [&] (const int* ib) -> long
+    {
+        long key = 0;
+        for (int d = BL_SPACEDIM-1; d >= 0; d--)
+            key = key * nbin[d] + ib[d];
+        return key;
+    };
+
+    Array<long> order(nsrc), keys(nsrc);
+    for (long j = 0; j < nsrc; j++)
+    {
+        int ib[BL_SPACEDIM];
+        bin_of(&src[nr*j], ib);
+        keys[j]  = key_of(ib);
+        order[j] = j;
+    }
+    std::sort(order.begin(), order.end(),
+              [&] (long l, long r) { return keys[l] < keys[r]; });
+
+    Array<long> skeys(nsrc);
+    Array<Real> ssrc(nr*nsrc);
+    for (long j = 0; j < nsrc; j++)
+    {
+        skeys[j] = keys[order[j]];
+        for (int c = 0; c < nr; c++)
+            ssrc[nr*j+c] = src[nr*order[j]+c];
+    }
+    Array<Real>().swap(src);
+    Array<long>().swap(keys);
+    Array<long>().swap(order);
+
+    const Real rcut2    = rcut * rcut;
+    const Real eps2     = eps * eps;
+    const Real half_rsi = 0.5 / rs;
+    const Real fac_exp  = 1.0 / (rs * std::sqrt(M_PI));
+    const Box  nbrs(IntVect(D_DECL(-1,-1,-1)), IntVect(D_DECL(1,1,1)));
+
+    for (auto& kv : pmap)
+    {
+        AoS&      pbox = kv.second.GetArrayOfStructs();
+        const int n    = pbox.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,64)
+#endif
+        for (int i = 0; i < n; i++)
+        {
+            ParticleType& p = pbox[i];
+
+            if (p.id() <= 0) continue;
+
+            Real x[BL_SPACEDIM] = { D_DECL(p.pos(0), p.pos(1), p.pos(2)) };
+            int  ib[BL_SPACEDIM];
+            bin_of(x, ib);
+
+            Real acc[BL_SPACEDIM] = { D_DECL(0, 0, 0) };
+
+            for (IntVect off = nbrs.smallEnd(); off <= nbrs.bigEnd(); nbrs.next(off))
+            {
+                int nb[BL_SPACEDIM];
+                for (int d = 0; d < BL_SPACEDIM; d++)
+                    nb[d] = ib[d] + off[d];
+
+                const long key = key_of(nb);
+                const auto range = std::equal_range(skeys.begin(), skeys.end(), key);
+
+                for (long j = range.first - skeys.begin(); j < range.second - skeys.begin(); j++)
+                {
+                    const Real* q = &ssrc[nr*j];
+                    Real sep[BL_SPACEDIM];
+                    Real r2 = 0;
+                    for (int d = 0; d < BL_SPACEDIM; d++)
+                    {
+                        sep[d] = q[d] - x[d];
+                        r2    += sep[d] * sep[d];
+                    }
+
+                    // The particle itself is among the sources
+                    if (r2 >= rcut2 || r2 == 0) continue;
+
+                    const Real r   = std::sqrt(r2);
+                    const Real u   = r * half_rsi;
+                    const Real S   = std::erfc(u) + r * fac_exp * std::exp(-u*u);
+                    const Real re2 = r2 + eps2;
+                    const Real f   = q[BL_SPACEDIM] * S / (re2 * std::sqrt(re2));
+
+                    for (int d = 0; d < BL_SPACEDIM; d++)
+                        acc[d] += f * sep[d];
+                }
+            }
+
+            D_TERM(p.rdata(1) += fac * acc[0];,
+                   p.rdata(2) += fac * acc[1];,
+                   p.rdata(3) += fac * acc[2];);
+        }
+    }
+}
+
+//
+// Add the accelerations on targets [t0,t1) of (tx,ty,tz) from sources
+// [0,ns) of (sx,sy,sz,sm), blocked so that a tile of sources stays in cache
+// while a few targets sweep over it.  With Ewald the separations take the
+// nearest periodic image and only the real-space part of the sum is added.
+//
+template <bool Ewald>
+static
+void
+direct_block (long t0, long t1, const Real* tx, const Real* ty, const Real* tz,
+              long ns, const Real* sx, const Real* sy, const Real* sz, const Real* sm,
+              Real* ax, Real* ay, Real* az, Real eps2, Real alpha,
+              const Real* L, const Real* Linv)
+{
+    const long src_tile = 1024;
+    const Real two_alpha_sqrtpi = 2.0 * alpha / std::sqrt(M_PI);
+
+    for (long s0 = 0; s0 < ns; s0 += src_tile)
+    {
+        const long s1 = std::min(s0 + src_tile, ns);
+
+        for (long i = t0; i < t1; i++)
+        {
+            const Real xi = tx[i], yi = ty[i], zi = tz[i];
+            Real axi = 0, ayi = 0, azi = 0;
+
+#ifdef _OPENMP
+#pragma omp simd reduction(+:axi,ayi,azi)
+#endif
+            for (long j = s0; j < s1; j++)
+            {
+                Real dx = sx[j] - xi;
+                Real dy = sy[j] - yi;
+                Real dz = sz[j] - zi;
+                if (Ewald)
+                {
+                    dx -= L[0] * std::floor(dx * Linv[0] + 0.5);
+                    dy -= L[1] * std::floor(dy * Linv[1] + 0.5);
+                    dz -= L[2] * std::floor(dz * Linv[2] + 0.5);
+                }
+                const Real r2  = dx*dx + dy*dy + dz*dz;
+                const Real re2 = r2 + eps2;
+                Real f = sm[j] / (re2 * std::sqrt(re2));
+                if (Ewald)
+                {
+                    const Real ar = alpha * std::sqrt(r2);
+                    f *= std::erfc(ar) + two_alpha_sqrtpi * std::sqrt(r2) * std::exp(-ar*ar);
+                }
+                // Skips the particle itself, and the padding
+                f = (r2 > 0) ? f : 0;
+                axi += f * dx;
+                ayi += f * dy;
+                azi += f * dz;
+            }
+
+            ax[i] += axi;
+            ay[i] += ayi;
+            az[i] += azi;
+        }
+    }
+}
+
+void
+DarkMatterParticleContainer::DirectAccelerations (Array<Real>& accel, Real fac, Real eps)
+{
+    BL_PROFILE("DarkMatterParticleContainer::DirectAccelerations()");
+
+    BL_ASSERT(BL_SPACEDIM == 3);
+
+    const int       MyProc = ParallelDescriptor::MyProc();
+    const int       NProcs = ParallelDescriptor::NProcs();
+    const Geometry& geom   = m_gdb->Geom(0);
+
+    const bool ewald = Geometry::isAllPeriodic();
+    if (!ewald && Geometry::isAnyPeriodic())
+        amrex::Abort("DirectAccelerations: the domain must be fully periodic or not at all");
+
+    //
+    // The local particles are the targets, and the first block of sources.
+    //
+    Array<Real> tx, ty, tz, tm;
+    for (int lev = 0; lev < this->GetParticles().size(); lev++)
+    {
+        for (auto& kv : this->GetParticles(lev))
+        {
+            const AoS& pbox = kv.second.GetArrayOfStructs();
+            for (int i = 0; i < pbox.size(); i++)
+            {
+                const ParticleType& p = pbox[i];
+                if (p.id() <= 0) continue;
+                tx.push_back(p.pos(0));
+                ty.push_back(p.pos(1));
+                tz.push_back(p.pos(2));
+                tm.push_back(p.rdata(0));
+            }
+        }
+    }
+
+    const long nloc = tx.size();
+    long       nmax = nloc;
+    ParallelDescriptor::ReduceLongMax(nmax);
+
+    Array<Real> ax(nloc, 0), ay(nloc, 0), az(nloc, 0);
+
+    Real L[3], Linv[3];
+    for (int d = 0; d < 3; d++)
+    {
+        L[d]    = geom.ProbLength(d);
+        Linv[d] = 1.0 / L[d];
+    }
+
+    //
+    // Ewald splitting parameter: with alpha = 7/L_min the real-space part
+    // beyond the nearest image, erfc(3.5) ~ 1e-6, can be dropped.
+    //
+    const Real alpha = ewald ? 7.0 / std::min(L[0], std::min(L[1], L[2])) : 0;
+    const Real eps2  = eps * eps;
+
+    //
+    // Blocks of nmax sources (x, y, z, m), padded with massless particles,
+    // go around the ranks in a ring; each is sent on while it is used.
+    //
+    Array<Real> blk(4*nmax, 0), nxt(4*nmax, 0);
+    std::copy(tx.begin(), tx.end(), blk.begin());
+    std::copy(ty.begin(), ty.end(), blk.begin() +   nmax);
+    std::copy(tz.begin(), tz.end(), blk.begin() + 2*nmax);
+    std::copy(tm.begin(), tm.end(), blk.begin() + 3*nmax);
+
+    const int  right = (MyProc + 1) % NProcs;
+    const int  left  = (MyProc + NProcs - 1) % NProcs;
+    const long target_tile = 64;
+
+    for (int step = 0; step < NProcs; step++)
+    {
+#ifdef BL_USE_MPI
+        MPI_Request reqs[2];
+        const bool pass = (step < NProcs-1);
+        if (pass)
+        {
+            const int SeqNum = ParallelDescriptor::SeqNum();
+            BL_ASSERT(4*nmax < std::numeric_limits<int>::max());
+            reqs[0] = ParallelDescriptor::Arecv(nxt.dataPtr(), 4*nmax, left, SeqNum).req();
+            BL_MPI_REQUIRE( MPI_Isend(blk.dataPtr(), 4*nmax,
+                                      ParallelDescriptor::Mpi_typemap<Real>::type(),
+                                      right, SeqNum, ParallelDescriptor::Communicator(), &reqs[1]) );
+        }
+#endif
+
+        const Real* sx = blk.dataPtr();
+        const Real* sy = sx + nmax;
+        const Real* sz = sy + nmax;
+        const Real* sm = sz + nmax;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (long t0 = 0; t0 < nloc; t0 += target_tile)
+        {
+            const long t1 = std::min(t0 + target_tile, nloc);
+            if (ewald)
+                direct_block<true >(t0, t1, tx.dataPtr(), ty.dataPtr(), tz.dataPtr(),
+                                    nmax, sx, sy, sz, sm, ax.dataPtr(), ay.dataPtr(), az.dataPtr(),
+                                    eps2, alpha, L, Linv);
+            else
+                direct_block<false>(t0, t1, tx.dataPtr(), ty.dataPtr(), tz.dataPtr(),
+                                    nmax, sx, sy, sz, sm, ax.dataPtr(), ay.dataPtr(), az.dataPtr(),
+                                    eps2, alpha, L, Linv);
+        }
+
+#ifdef BL_USE_MPI
+        if (pass)
+        {
+            MPI_Status stats[2];
+            BL_MPI_REQUIRE( MPI_Waitall(2, reqs, stats) );
+            std::swap(blk, nxt);
+        }
+#endif
+    }
+
+    if (ewald)
+    {
+        //
+        // Fourier-space part of the Ewald sum, over the half space of wave
+        // vectors with exp(-k^2/4 alpha^2) > 1e-6, from the structure factors
+        // C(k) = sum m cos(k.x) and S(k) = sum m sin(k.x) of all particles.
+        //
+        const Real kmax = 2.0 * alpha * std::sqrt(std::log(1.e6));
+        int hmax[3];
+        for (int d = 0; d < 3; d++)
+            hmax[d] = static_cast<int>(kmax * L[d] / (2.0*M_PI));
+
+        Array<Real> kvec, kcoef;
+        const Real fourpi_vol = 4.0 * M_PI * Linv[0] * Linv[1] * Linv[2];
+        for (int hx = 0; hx <= hmax[0]; hx++)
+        for (int hy = -hmax[1]; hy <= hmax[1]; hy++)
+        for (int hz = -hmax[2]; hz <= hmax[2]; hz++)
+        {
+            if (hx == 0 && (hy < 0 || (hy == 0 && hz <= 0))) continue;
+            const Real k[3] = { 2.0*M_PI*hx*Linv[0], 2.0*M_PI*hy*Linv[1], 2.0*M_PI*hz*Linv[2] };
+            const Real k2   = k[0]*k[0] + k[1]*k[1] + k[2]*k[2];
+            if (k2 > kmax*kmax) continue;
+            kvec.insert(kvec.end(), k, k+3);
+            // Twice, for -k
+            kcoef.push_back(2.0 * fourpi_vol * std::exp(-0.25*k2/(alpha*alpha)) / k2);
+        }
+
+        const int nk = kcoef.size();
+        Array<Real> CS(2*nk, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int n = 0; n < nk; n++)
+        {
+            const Real* k = &kvec[3*n];
+            Real c = 0, s = 0;
+            for (long i = 0; i < nloc; i++)
+            {
+                const Real ph = k[0]*tx[i] + k[1]*ty[i] + k[2]*tz[i];
+                c += tm[i] * std::cos(ph);
+                s += tm[i] * std::sin(ph);
+            }
+            CS[n]    = c;
+            CS[nk+n] = s;
+        }
+
+        ParallelDescriptor::ReduceRealSum(CS.dataPtr(), 2*nk);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < nloc; i++)
+        {
+            for (int n = 0; n < nk; n++)
+            {
+                const Real* k  = &kvec[3*n];
+                const Real  ph = k[0]*tx[i] + k[1]*ty[i] + k[2]*tz[i];
+                const Real  w  = kcoef[n] * (std::sin(ph)*CS[n] - std::cos(ph)*CS[nk+n]);
+                ax[i] -= w * k[0];
+                ay[i] -= w * k[1];
+                az[i] -= w * k[2];
+            }
+        }
+    }
+
+    accel.resize(3*nloc);
+    for (long i = 0; i < nloc; i++)
+    {
+        accel[3*i  ] = fac * ax[i];
+        accel[3*i+1] = fac * ay[i];
+        accel[3*i+2] = fac * az[i];
+    }
+}
+
+void
+DarkMatterParticleContainer::MeshAccelerations (Array<Real>& accel, int lev, MultiFab& grav)
+{
+    BL_PROFILE("DarkMatterParticleContainer::MeshAccelerations()");
+
+    if (lev >= this->GetParticles().size())
+        return;
+
+    std::unique_ptr<MultiFab> grav_copy;
+    MultiFab* gp = &grav;
+    if (!this->OnSameGrids(lev, grav))
+    {
+        grav_copy.reset(new MultiFab(m_gdb->ParticleBoxArray(lev), m_gdb->ParticleDistributionMap(lev),
+                                     grav.nComp(), grav.nGrow()));
+        grav_copy->setVal(0.);
+        grav_copy->copy(grav, 0, 0, grav.nComp());
+        grav_copy->FillBoundary();
+        gp = grav_copy.get();
+    }
+
+    for (auto& kv : this->GetParticles(lev))
+    {
+        const FArrayBox& gfab = (*gp)[kv.first.first];
+        const AoS&       pbox = kv.second.GetArrayOfStructs();
+        for (int i = 0; i < pbox.size(); i++)
+        {
+            const ParticleType& p = pbox[i];
+            if (p.id() <= 0) continue;
+            Real g[BL_SPACEDIM];
+            ParticleType::GetGravity(gfab, m_gdb->Geom(lev), p, g);
+            accel.insert(accel.end(), g, g+BL_SPACEDIM);
+        }
+    }
+}
+
+void
+DarkMatterParticleContainer::DirectKickDrift (const Array<Real>& accel, Real dt,
+                                              Real a_from, Real a_to, int drift)
+{
+    BL_PROFILE("DarkMatterParticleContainer::DirectKickDrift()");
+
+    const Real half_dt     = 0.5 * dt;
+    const Real a_to_inv    = 1.0 / a_to;
+    const Real dt_a_to_inv = dt * a_to_inv;
+
+    long n = 0;
+    for (int lev = 0; lev < this->GetParticles().size(); lev++)
+    {
+        for (auto& kv : this->GetParticles(lev))
+        {
+            AoS& pbox = kv.second.GetArrayOfStructs();
+            for (int i = 0; i < pbox.size(); i++)
+            {
+                ParticleType& p = pbox[i];
+                if (p.id() <= 0) continue;
+
+                const Real* g = &accel[BL_SPACEDIM*n++];
+
+                // (a u)^to = (a u)^from + dt/2 g
+                for (int d = 0; d < BL_SPACEDIM; d++)
+                    p.rdata(1+d) = (a_from * p.rdata(1+d) + half_dt * g[d]) * a_to_inv;
+
+                if (drift)
+                    for (int d = 0; d < BL_SPACEDIM; d++)
+                        p.pos(d) += dt_a_to_inv * p.rdata(1+d);
+            }
+        }
+    }
+
+    BL_ASSERT(BL_SPACEDIM*n == accel.size());
+}
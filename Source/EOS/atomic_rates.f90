@@ -20,25 +20,40 @@ module atomic_rates_module
   implicit none
 
   ! Routine which acts like a class constructor
-  public  :: tabulate_rates, interp_to_this_z
-
-  ! Photo- rates (from file)
-  integer   , parameter          , private :: NCOOLFILE=301
-  real(rt), dimension(NCOOLFILE), public :: lzr
-  real(rt), dimension(NCOOLFILE), public :: rggh0, rgghe0, rgghep
-  real(rt), dimension(NCOOLFILE), public :: reh0, rehe0, rehep
-
-  ! Other rates (from equations)
-  integer, parameter, public :: NCOOLTAB=2000
-  real(rt), dimension(NCOOLTAB+1), public :: AlphaHp, AlphaHep, AlphaHepp, Alphad
-  real(rt), dimension(NCOOLTAB+1), public :: GammaeH0, GammaeHe0, GammaeHep
-  real(rt), dimension(NCOOLTAB+1), public :: BetaH0, BetaHe0, BetaHep, Betaff1, Betaff4
-  real(rt), dimension(NCOOLTAB+1), public :: RecHp, RecHep, RecHepp
-
-  real(rt), public, save :: this_z, ggh0, gghe0, gghep, eh0, ehe0, ehep
+  public  :: tabulate_rates, interp_rates, interp_to_this_z, set_uvb_table
+
+  ! Photo- rates (from file, set by fort_set_uvb_table)
+  integer, public, save :: NCOOLFILE = 0
+  real(rt), allocatable, dimension(:), public, save :: lzr
+  real(rt), allocatable, dimension(:), public, save :: rggh0, rgghe0, rgghep
+  real(rt), allocatable, dimension(:), public, save :: reh0, rehe0, rehep
+
+  ! Uniform bins in log10(1+z), no wider than the narrowest table interval;
+  ! uvb_bin(b) is the table interval containing the lower edge of bin b
+  integer, allocatable, dimension(:), private, save :: uvb_bin
+  real(rt), private, save :: uvb_dlzr_inv
+
+  ! Other rates (from equations), tabulated uniformly in log10(T) on NCOOLTAB+1
+  ! points.  Each column of rate_tab holds all the rates at one temperature so a
+  ! lookup touches two adjacent columns; rate_dtab holds the monotone cubic
+  ! (Fritsch-Butland) slopes, in units of rate per table interval.
+  integer, public, save :: NCOOLTAB = 2000
+
+  integer, parameter, public :: IAHP   =  1, IAHEP  =  2, IAHEPP =  3, IAD    =  4
+  integer, parameter, public :: IGEH0  =  5, IGEHE0 =  6, IGEHEP =  7
+  integer, parameter, public :: IBH0   =  8, IBHE0  =  9, IBHEP  = 10, IBFF1  = 11, IBFF4 = 12
+  integer, parameter, public :: IRHP   = 13, IRHEP  = 14, IRHEPP = 15
+
+  ! The ionization balance only needs the first NION_RATES
+  integer, parameter, public :: NION_RATES = 7, NRATES = 15
+
+  real(rt), allocatable, dimension(:,:), public, save :: rate_tab, rate_dtab
+
+  real(rt), public, save :: this_z = -1.d0
+  real(rt), public, save :: ggh0, gghe0, gghep, eh0, ehe0, ehep
  
   real(rt), parameter, public :: TCOOLMIN = 0.0d0, TCOOLMAX = 9.0d0  ! in log10
-  real(rt), parameter, public :: deltaT = (TCOOLMAX - TCOOLMIN)/NCOOLTAB
+  real(rt), public, save :: deltaT, deltaT_inv
 
   real(rt), parameter, public :: MPROTON = 1.6726231d-24, BOLTZMANN = 1.3806e-16
 
@@ -49,25 +64,35 @@ module atomic_rates_module
 
   contains
 
-      subroutine tabulate_rates()
+      subroutine tabulate_rates(ncooltab_in)
+      integer, intent(in) :: ncooltab_in
       integer :: i
       logical, parameter :: Katz96=.false.
       real(rt), parameter :: t3=1.0d3, t5=1.0d5, t6=1.0d6
       real(rt) :: t, U, E, y, sqrt_t, corr_term
+      real(rt), allocatable, dimension(:) :: AlphaHp, AlphaHep, AlphaHepp, Alphad
+      real(rt), allocatable, dimension(:) :: GammaeH0, GammaeHe0, GammaeHep
+      real(rt), allocatable, dimension(:) :: BetaH0, BetaHe0, BetaHep, Betaff1, Betaff4
+      real(rt), allocatable, dimension(:) :: RecHp, RecHep, RecHepp
       logical, save :: first=.true.
 
+      ! The photo- rates are read once on the C++ side (Nyx::read_uvb_table)
+      ! and handed to set_uvb_table on every rank
+
       !$OMP CRITICAL(TREECOOL_READ)
       if (first) then
 
          first = .false.
 
-         ! Read in photoionization rates and heating from a file
-         open(unit=11,file='TREECOOL_middle',status='old')
-         do i = 1, NCOOLFILE
-            read(11,*) lzr(i), rggh0(i), rgghe0(i), rgghep(i), &
-                                reh0(i),  rehe0(i),  rehep(i)
-         end do
-         close(11)
+         NCOOLTAB   = ncooltab_in
+         deltaT     = (TCOOLMAX - TCOOLMIN)/NCOOLTAB
+         deltaT_inv = NCOOLTAB/(TCOOLMAX - TCOOLMIN)
+
+         allocate(AlphaHp(NCOOLTAB+1), AlphaHep(NCOOLTAB+1), AlphaHepp(NCOOLTAB+1), Alphad(NCOOLTAB+1))
+         allocate(GammaeH0(NCOOLTAB+1), GammaeHe0(NCOOLTAB+1), GammaeHep(NCOOLTAB+1))
+         allocate(BetaH0(NCOOLTAB+1), BetaHe0(NCOOLTAB+1), BetaHep(NCOOLTAB+1))
+         allocate(Betaff1(NCOOLTAB+1), Betaff4(NCOOLTAB+1))
+         allocate(RecHp(NCOOLTAB+1), RecHep(NCOOLTAB+1), RecHepp(NCOOLTAB+1))
 
          ! Initialize cooling tables
          t = 10.0d0**TCOOLMIN
@@ -176,6 +201,30 @@ module atomic_rates_module
             enddo
          endif  ! Katz rates
 
+         ! Pack the rates by temperature and get the interpolation slopes
+         allocate(rate_tab(NRATES,NCOOLTAB+1), rate_dtab(NRATES,NCOOLTAB+1))
+
+         rate_tab(IAHP  ,:) = AlphaHp
+         rate_tab(IAHEP ,:) = AlphaHep
+         rate_tab(IAHEPP,:) = AlphaHepp
+         rate_tab(IAD   ,:) = Alphad
+         rate_tab(IGEH0 ,:) = GammaeH0
+         rate_tab(IGEHE0,:) = GammaeHe0
+         rate_tab(IGEHEP,:) = GammaeHep
+         rate_tab(IBH0  ,:) = BetaH0
+         rate_tab(IBHE0 ,:) = BetaHe0
+         rate_tab(IBHEP ,:) = BetaHep
+         rate_tab(IBFF1 ,:) = Betaff1
+         rate_tab(IBFF4 ,:) = Betaff4
+         rate_tab(IRHP  ,:) = RecHp
+         rate_tab(IRHEP ,:) = RecHep
+         rate_tab(IRHEPP,:) = RecHepp
+
+         call monotone_slopes(rate_tab, rate_dtab)
+
+         deallocate(AlphaHp, AlphaHep, AlphaHepp, Alphad, GammaeH0, GammaeHe0, GammaeHep)
+         deallocate(BetaH0, BetaHe0, BetaHep, Betaff1, Betaff4, RecHp, RecHep, RecHepp)
+
       end if  ! first_call
       !$OMP END CRITICAL(TREECOOL_READ)
 
@@ -183,44 +232,166 @@ module atomic_rates_module
 
       ! ****************************************************************************
 
+      subroutine monotone_slopes(tab, dtab)
+
+      ! Fritsch-Butland slopes: the harmonic mean of the neighbouring secants, or
+      ! zero at a local extremum, so that the cubic Hermite interpolant never
+      ! overshoots the tabulated data.  One-sided secants at the ends.
+
+      real(rt), intent(in   ) :: tab(:,:)
+      real(rt), intent(  out) :: dtab(:,:)
+      real(rt) :: dlo, dhi
+      integer :: i, n, np
+
+      np = size(tab,2)
+
+      do n = 1, size(tab,1)
+         dtab(n, 1) = tab(n, 2) - tab(n,   1)
+         dtab(n,np) = tab(n,np) - tab(n,np-1)
+      end do
+
+      do i = 2, np-1
+         do n = 1, size(tab,1)
+            dlo = tab(n,i  ) - tab(n,i-1)
+            dhi = tab(n,i+1) - tab(n,i  )
+            if (dlo*dhi .gt. 0.0d0) then
+               dtab(n,i) = 2.0d0*dlo*dhi/(dlo+dhi)
+            else
+               dtab(n,i) = 0.0d0
+            end if
+         end do
+      end do
+
+      end subroutine monotone_slopes
+
+      ! ****************************************************************************
+
+      subroutine interp_rates(logT, nr, rates)
+
+      ! All rates 1..nr at one temperature (log10 T < TCOOLMAX), sharing the
+      ! index and Hermite weights.  Below TCOOLMIN the rates are held at the
+      ! middle of the first interval, as before.
+
+      real(rt), intent(in   ) :: logT
+      integer , intent(in   ) :: nr
+      real(rt), intent(  out) :: rates(nr)
+      real(rt) :: tmp, x, h00, h01, h10, h11
+      integer :: j
+
+      if (logT .le. TCOOLMIN) then
+         tmp = 0.5d0
+      else
+         tmp = (logT-TCOOLMIN)*deltaT_inv
+      end if
+      j = int(tmp)
+      x = tmp - j
+      j = j + 1 ! F90 arrays start with 1
+
+      h01 = x*x*(3.0d0 - 2.0d0*x)
+      h00 = 1.0d0 - h01
+      h10 = x*(1.0d0-x)*(1.0d0-x)
+      h11 = x*x*(x-1.0d0)
+
+      rates = h00*rate_tab (1:nr,j) + h01*rate_tab (1:nr,j+1) &
+            + h10*rate_dtab(1:nr,j) + h11*rate_dtab(1:nr,j+1)
+
+      end subroutine interp_rates
+
+      ! ****************************************************************************
+
+      subroutine set_uvb_table(n, table)
+
+      integer , intent(in) :: n
+      real(rt), intent(in) :: table(7,n)
+      real(rt) :: dlzr_min, edge
+      integer :: i, b, nbin
+
+      if (allocated(lzr)) then
+         deallocate(lzr, rggh0, rgghe0, rgghep, reh0, rehe0, rehep, uvb_bin)
+      end if
+
+      NCOOLFILE = n
+      allocate(lzr(n), rggh0(n), rgghe0(n), rgghep(n), reh0(n), rehe0(n), rehep(n))
+
+      lzr    = table(1,:)
+      rggh0  = table(2,:)
+      rgghe0 = table(3,:)
+      rgghep = table(4,:)
+      reh0   = table(5,:)
+      rehe0  = table(6,:)
+      rehep  = table(7,:)
+
+      dlzr_min = minval(lzr(2:n) - lzr(1:n-1))
+      nbin = int((lzr(n) - lzr(1))/dlzr_min) + 1
+      uvb_dlzr_inv = nbin / (lzr(n) - lzr(1))
+
+      allocate(uvb_bin(nbin))
+      i = 1
+      do b = 1, nbin
+         edge = lzr(1) + (b-1) / uvb_dlzr_inv
+         do while (i .lt. n-1 .and. lzr(i+1) .le. edge)
+            i = i + 1
+         end do
+         uvb_bin(b) = i
+      end do
+
+      ! Force the next interp_to_this_z to use the new table
+      this_z = -1.d0
+
+      end subroutine set_uvb_table
+
+      ! ****************************************************************************
+
       subroutine interp_to_this_z(z)
 
       real(rt), intent(in) :: z
       real(rt) :: lopz, fact
-      integer :: i, j
-
-      this_z = z
-      lopz   = dlog10(1.0d0 + z)
-
-      if (lopz .ge. lzr(NCOOLFILE)) then
-         ggh0  = 0.0d0
-         gghe0 = 0.0d0
-         gghep = 0.0d0
-         eh0   = 0.0d0
-         ehe0  = 0.0d0
-         ehep  = 0.0d0
-         return
-      endif
-
-      if (lopz .le. lzr(1)) then
-         j = 1
-      else
-         do i = 2, NCOOLFILE
-            if (lopz .lt. lzr(i)) then
-               j = i-1
-               exit
+      integer :: j
+
+      ! All the calls within a step ask for the same z, so only the first
+      ! one interpolates; the check is inside the critical section so that
+      ! no thread reads this_z while another is writing the rates
+      !$OMP CRITICAL(UVB_INTERP)
+      if (z .ne. this_z) then
+
+         lopz = dlog10(1.0d0 + z)
+
+         if (lopz .ge. lzr(NCOOLFILE)) then
+            ggh0  = 0.0d0
+            gghe0 = 0.0d0
+            gghep = 0.0d0
+            eh0   = 0.0d0
+            ehe0  = 0.0d0
+            ehep  = 0.0d0
+         else
+            if (lopz .le. lzr(1)) then
+               j = 1
+            else
+               ! At most one step either way from the bin's interval
+               j = uvb_bin(min(int((lopz-lzr(1))*uvb_dlzr_inv) + 1, size(uvb_bin)))
+               do while (lopz .ge. lzr(j+1))
+                  j = j + 1
+               end do
+               do while (lopz .lt. lzr(j))
+                  j = j - 1
+               end do
             endif
-         enddo
-      endif
 
-      fact  = (lopz-lzr(j))/(lzr(j+1)-lzr(j))
+            fact  = (lopz-lzr(j))/(lzr(j+1)-lzr(j))
+
+            ggh0  = rggh0(j)  + (rggh0(j+1)-rggh0(j))*fact
+            gghe0 = rgghe0(j) + (rgghe0(j+1)-rgghe0(j))*fact
+            gghep = rgghep(j) + (rgghep(j+1)-rgghep(j))*fact
+            eh0   = reh0(j)   + (reh0(j+1)-reh0(j))*fact
+            ehe0  = rehe0(j)  + (rehe0(j+1)-rehe0(j))*fact
+            ehep  = rehep(j)  + (rehep(j+1)-rehep(j))*fact
+         endif
 
-      ggh0  = rggh0(j)  + (rggh0(j+1)-rggh0(j))*fact
-      gghe0 = rgghe0(j) + (rgghe0(j+1)-rgghe0(j))*fact
-      gghep = rgghep(j) + (rgghep(j+1)-rgghep(j))*fact
-      eh0   = reh0(j)   + (reh0(j+1)-reh0(j))*fact
-      ehe0  = rehe0(j)  + (rehe0(j+1)-rehe0(j))*fact
-      ehep  = rehep(j)  + (rehep(j+1)-rehep(j))*fact
+         ! Set last, so a thread that sees the new z also sees its rates
+         this_z = z
+
+      end if
+      !$OMP END CRITICAL(UVB_INTERP)
 
       end subroutine interp_to_this_z
 
@@ -245,3 +416,35 @@ subroutine fort_init_this_z(comoving_a) &
     call interp_to_this_z(z)
 
 end subroutine fort_init_this_z
+
+! *************************************************************************************
+
+subroutine fort_set_uvb_table(nrows, table) &
+    bind(C, name="fort_set_uvb_table")
+
+    use amrex_fort_module, only : rt => amrex_real
+    use atomic_rates_module, only : set_uvb_table
+
+    implicit none
+
+    integer , intent(in) :: nrows
+    real(rt), intent(in) :: table(7,nrows)
+
+    call set_uvb_table(nrows, table)
+
+end subroutine fort_set_uvb_table
+
+! *************************************************************************************
+
+subroutine fort_tabulate_rates(ncooltab) &
+    bind(C, name="fort_tabulate_rates")
+
+    use atomic_rates_module, only : tabulate_rates
+
+    implicit none
+
+    integer, intent(in) :: ncooltab
+
+    call tabulate_rates(ncooltab)
+
+end subroutine fort_tabulate_rates
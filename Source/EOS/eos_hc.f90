@@ -224,19 +224,18 @@ module eos_module
       subroutine ion_n(U, nh, ne, nhp, nhep, nhepp, t)
 
       use meth_params_module, only: gamma_minus_1
-      use atomic_rates_module, ONLY: YHELIUM, MPROTON, BOLTZMANN, &
-                                     TCOOLMIN, TCOOLMAX, NCOOLTAB, deltaT, &
-                                     AlphaHp, AlphaHep, AlphaHepp, Alphad, &
-                                     GammaeH0, GammaeHe0, GammaeHep, &
+      use atomic_rates_module, ONLY: YHELIUM, MPROTON, BOLTZMANN, TCOOLMAX, &
+                                     NION_RATES, interp_rates, &
+                                     IAHP, IAHEP, IAHEPP, IAD, IGEH0, IGEHE0, IGEHEP, &
                                      ggh0, gghe0, gghep
 
       real(rt), intent(in   ) :: U, nh, ne
       real(rt), intent(  out) :: nhp, nhep, nhepp, t
       real(rt) :: ahp, ahep, ahepp, ad, geh0, gehe0, gehep
       real(rt) :: ggh0ne, gghe0ne, gghepne
-      real(rt) :: mu, tmp, logT, flo, fhi
+      real(rt) :: rates(NION_RATES)
+      real(rt) :: mu, logT
       real(rt) :: smallest_val
-      integer :: j
 
       mu = (1.0d0+4.0d0*YHELIUM) / (1.0d0+YHELIUM+ne)
       t  = gamma_minus_1*MPROTON/BOLTZMANN * U * mu
@@ -249,23 +248,15 @@ module eos_module
          return
       endif
 
-      ! Temperature floor
-      if (logT .le. TCOOLMIN) logT = TCOOLMIN + 0.5d0*deltaT
-
-      ! Interpolate rates
-      tmp = (logT-TCOOLMIN)/deltaT
-      j = int(tmp)
-      fhi = tmp - j
-      flo = 1.0d0 - fhi
-      j = j + 1 ! F90 arrays start with 1
-
-      ahp   = flo*AlphaHp  (j) + fhi*AlphaHp  (j+1)
-      ahep  = flo*AlphaHep (j) + fhi*AlphaHep (j+1)
-      ahepp = flo*AlphaHepp(j) + fhi*AlphaHepp(j+1)
-      ad    = flo*Alphad   (j) + fhi*Alphad   (j+1)
-      geh0  = flo*GammaeH0 (j) + fhi*GammaeH0 (j+1)
-      gehe0 = flo*GammaeHe0(j) + fhi*GammaeHe0(j+1)
-      gehep = flo*GammaeHep(j) + fhi*GammaeHep(j+1)
+      ! Interpolate rates (the temperature floor is applied in interp_rates)
+      call interp_rates(logT, NION_RATES, rates)
+      ahp   = rates(IAHP)
+      ahep  = rates(IAHEP)
+      ahepp = rates(IAHEPP)
+      ad    = rates(IAD)
+      geh0  = rates(IGEH0)
+      gehe0 = rates(IGEHE0)
+      gehep = rates(IGEHEP)
 
       if (ne .gt. 0.0d0) then
          ggh0ne   = ggh0 /(ne*nh)
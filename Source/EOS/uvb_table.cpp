@@ -0,0 +1,46 @@
+#include <fstream>
+#include <sstream>
+
+#include "AMReX_Utility.H"
+
+#include "uvb_table.H"
+
+using namespace amrex;
+
+int
+read_uvb_file (const std::string& uvb_file, Array<Real>& table)
+{
+    const int ncol = 7;
+
+    std::ifstream File;
+    File.open(uvb_file.c_str(),std::ios::in);
+    if (!File.good())
+        amrex::FileOpenFailed(uvb_file);
+
+    table.clear();
+    int nrows = 0;
+
+    std::string line;
+    while (std::getline(File,line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#')
+            continue;
+
+        std::istringstream is(line);
+        Real row[ncol];
+        for (int n = 0; n < ncol; n++)
+            if (!(is >> row[n]))
+                amrex::Abort("read_uvb_file: expected 7 columns in " + uvb_file);
+
+        if (nrows > 0 && row[0] <= table[ncol*(nrows-1)])
+            amrex::Abort("read_uvb_file: log10(1+z) must increase in " + uvb_file);
+
+        table.insert(table.end(), row, row+ncol);
+        nrows++;
+    }
+
+    if (nrows < 2)
+        amrex::Abort("read_uvb_file: need at least two redshifts in " + uvb_file);
+
+    return nrows;
+}
@@ -0,0 +1,857 @@
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include <AMReX_ParallelDescriptor.H>
+#include "GeometricMG.H"
+#include <Gravity_F.H>
+
+using namespace amrex;
+
+//
+// Whether box can be coarsened by 2 and still be at least 2 cells wide.
+//
+static
+bool
+can_coarsen (const Box& box)
+{
+    for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+        if (box.smallEnd(dir) % 2 != 0 || box.length(dir) % 2 != 0 || box.length(dir) < 4)
+            return false;
+    return true;
+}
+
+static
+bool
+can_coarsen (const BoxArray& ba)
+{
+    for (int i = 0; i < ba.size(); ++i)
+        if (!can_coarsen(ba[i]))
+            return false;
+    return true;
+}
+
+//
+// The number of distinct ranks that dm puts boxes on.
+//
+static
+int
+num_ranks (const DistributionMapping& dm)
+{
+    const Array<int>& pmap = dm.ProcessorMap();
+    std::vector<int> ranks(pmap.begin(), pmap.end());
+    std::sort(ranks.begin(), ranks.end());
+    return std::unique(ranks.begin(), ranks.end()) - ranks.begin();
+}
+
+//
+// The domain chopped into at most nboxes boxes, halving their size while
+// they stay coarsenable.
+//
+static
+BoxArray
+gathered_grids (const Box& domain, long nboxes)
+{
+    BoxArray cba(domain);
+    int max_size = domain.longside();
+    while (max_size % 2 == 0)
+    {
+        BoxArray trial(domain);
+        trial.maxSize(max_size / 2);
+        if (trial.size() > nboxes || !can_coarsen(trial))
+            break;
+        cba = trial;
+        max_size /= 2;
+    }
+    return cba;
+}
+
+typedef FabArray<BaseFab<float> > FloatMultiFab;
+
+//
+// The kernels, for the levels of either precision.  The single-precision
+// fill_bc only knows the homogeneous boundary conditions, which is all the
+// cycles need.
+//
+static
+void
+gmg_fill_bc (const Box& bx, const Box& dom, BaseFab<Real>& phi,
+             const BaseFab<Real>* bndry, const int* bc)
+{
+    const int homog = bndry ? 0 : 1;
+    const BaseFab<Real>& bfab = bndry ? *bndry : phi;
+    FORT_GMG_FILL_BC(bx.loVect(), bx.hiVect(), dom.loVect(), dom.hiVect(),
+                     BL_TO_FORTRAN(phi), BL_TO_FORTRAN(bfab), bc, &homog);
+}
+
+static
+void
+gmg_fill_bc (const Box& bx, const Box& dom, BaseFab<float>& phi,
+             const BaseFab<Real>* bndry, const int* bc)
+{
+    BL_ASSERT(bndry == 0);
+    FORT_GMG_FILL_BC_SP(bx.loVect(), bx.hiVect(), dom.loVect(), dom.hiVect(),
+                        BL_TO_FORTRAN(phi), bc);
+}
+
+static
+void
+gmg_residual (const Box& bx, BaseFab<Real>& r, const BaseFab<Real>& x, const BaseFab<Real>& b,
+              const Real* dx, int order)
+{
+    FORT_GMG_RESIDUAL(bx.loVect(), bx.hiVect(),
+                      BL_TO_FORTRAN(r), BL_TO_FORTRAN(x), BL_TO_FORTRAN(b), dx, &order);
+}
+
+static
+void
+gmg_residual (const Box& bx, BaseFab<float>& r, const BaseFab<float>& x, const BaseFab<float>& b,
+              const Real* dx, int order)
+{
+    FORT_GMG_RESIDUAL_SP(bx.loVect(), bx.hiVect(),
+                         BL_TO_FORTRAN(r), BL_TO_FORTRAN(x), BL_TO_FORTRAN(b), dx, &order);
+}
+
+static
+void
+gmg_cheby (const Box& bx, BaseFab<Real>& xnew, const BaseFab<Real>& x, const BaseFab<Real>& xold,
+           const BaseFab<Real>& b, const Real* dx, int order, Real c1, Real c2)
+{
+    FORT_GMG_CHEBY(bx.loVect(), bx.hiVect(),
+                   BL_TO_FORTRAN(xnew), BL_TO_FORTRAN(x), BL_TO_FORTRAN(xold), BL_TO_FORTRAN(b),
+                   dx, &order, &c1, &c2);
+}
+
+static
+void
+gmg_cheby (const Box& bx, BaseFab<float>& xnew, const BaseFab<float>& x, const BaseFab<float>& xold,
+           const BaseFab<float>& b, const Real* dx, int order, Real c1, Real c2)
+{
+    FORT_GMG_CHEBY_SP(bx.loVect(), bx.hiVect(),
+                      BL_TO_FORTRAN(xnew), BL_TO_FORTRAN(x), BL_TO_FORTRAN(xold), BL_TO_FORTRAN(b),
+                      dx, &order, &c1, &c2);
+}
+
+static
+void
+gmg_restrict (const Box& bx, BaseFab<Real>& crse, const BaseFab<Real>& fine)
+{
+    FORT_GMG_RESTRICT(bx.loVect(), bx.hiVect(), BL_TO_FORTRAN(crse), BL_TO_FORTRAN(fine));
+}
+
+static
+void
+gmg_restrict (const Box& bx, BaseFab<float>& crse, const BaseFab<float>& fine)
+{
+    FORT_GMG_RESTRICT_SP(bx.loVect(), bx.hiVect(), BL_TO_FORTRAN(crse), BL_TO_FORTRAN(fine));
+}
+
+static
+void
+gmg_interp (const Box& bx, BaseFab<Real>& fine, const BaseFab<Real>& crse, int add)
+{
+    FORT_GMG_INTERP(bx.loVect(), bx.hiVect(), BL_TO_FORTRAN(fine), BL_TO_FORTRAN(crse), &add);
+}
+
+static
+void
+gmg_interp (const Box& bx, BaseFab<float>& fine, const BaseFab<float>& crse, int add)
+{
+    FORT_GMG_INTERP_SP(bx.loVect(), bx.hiVect(), BL_TO_FORTRAN(fine), BL_TO_FORTRAN(crse), &add);
+}
+
+//
+// dst = src, or dst += src, on the valid cells, converting between the
+// precisions where they differ.
+//
+static
+void
+copy_valid (MultiFab& dst, const MultiFab& src)
+{
+    MultiFab::Copy(dst, src, 0, 0, 1, 0);
+}
+
+static
+void
+copy_valid (FloatMultiFab& dst, const MultiFab& src)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        FORT_GMG_TO_SINGLE(bx.loVect(), bx.hiVect(),
+                           BL_TO_FORTRAN(dst[mfi]), BL_TO_FORTRAN(src[mfi]));
+    }
+}
+
+static
+void
+to_double (MultiFab& dst, const FloatMultiFab& src, int add)
+{
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(dst,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        FORT_GMG_TO_DOUBLE(bx.loVect(), bx.hiVect(),
+                           BL_TO_FORTRAN(dst[mfi]), BL_TO_FORTRAN(src[mfi]), &add);
+    }
+}
+
+static
+void
+copy_valid (MultiFab& dst, const FloatMultiFab& src)
+{
+    to_double(dst, src, 0);
+}
+
+static
+void
+add_valid (MultiFab& dst, const MultiFab& src)
+{
+    MultiFab::Add(dst, src, 0, 0, 1, 0);
+}
+
+static
+void
+add_valid (MultiFab& dst, const FloatMultiFab& src)
+{
+    to_double(dst, src, 1);
+}
+
+GeometricMG::GeometricMG (const Geometry&            geom,
+                          const BoxArray&            grids,
+                          const DistributionMapping& dmap,
+                          const int*                 bc_in,
+                          int                        order_in,
+                          int                        cheby_degree_in,
+                          int                        verbose_in,
+                          int                        agglomerate_cells,
+                          int                        single_precision_in)
+    :
+    order(order_in),
+    cheby_degree(cheby_degree_in),
+    verbose(verbose_in),
+    single_precision(single_precision_in)
+{
+    all_periodic = true;
+    for (int n = 0; n < 2*BL_SPACEDIM; ++n)
+    {
+        bc[n] = bc_in[n];
+        if (bc[n] != Periodic)
+            all_periodic = false;
+    }
+
+    if (order != 2 && order != 4)
+        amrex::Error("GeometricMG: order must be 2 or 4");
+
+    if (cheby_degree < 1)
+        amrex::Error("GeometricMG: cheby_degree must be >= 1");
+
+    if (grids.numPts() != geom.Domain().numPts())
+        amrex::Error("GeometricMG: the grids must cover the domain");
+
+    const Real* dx0 = geom.CellSize();
+
+    if (order == 4)
+    {
+        if (!all_periodic)
+            amrex::Error("GeometricMG: order 4 needs a periodic domain");
+        for (int dir = 1; dir < BL_SPACEDIM; ++dir)
+            if (std::abs(dx0[dir] - dx0[0]) > 1.e-10 * dx0[0])
+                amrex::Error("GeometricMG: order 4 needs cubic cells");
+    }
+
+    // Gershgorin gives 2 for the seven-point operator, which is attained;
+    // for the Mehrstellen operator the largest eigenvalue is 4/3.
+    lambda_max = (order == 4) ? 4.0/3.0 : 2.0;
+
+    ba.push_back(grids);
+    dm.push_back(dmap);
+    domain.push_back(geom.Domain());
+    dx.push_back(Array<Real>(dx0, dx0+BL_SPACEDIM));
+    agglomerated.push_back(0);
+
+    //
+    // Coarsen the grids in place while every box allows it, then gather the
+    // rest of the hierarchy into one box of the whole domain.  We gather one
+    // level early rather than coarsen into boxes that cannot be restricted
+    // to the next level (24 -> 12 -> 6 -> 3 at an odd offset, say).  With
+    // agglomerate_cells > 0, a coarsened level that would hold fewer cells
+    // than that per rank is instead spread over about cells / agglomerate_cells
+    // grids, one per rank, so the coarse levels run on fewer and fewer ranks.
+    //
+    while (can_coarsen(domain.back()))
+    {
+        const Box cdomain = amrex::coarsen(domain.back(),2);
+
+        BoxArray cba;
+        DistributionMapping cdm;
+        int agg;
+
+        bool in_place = can_coarsen(ba.back());
+        if (in_place)
+        {
+            cba = ba.back();
+            cba.coarsen(2);
+            if (can_coarsen(cdomain))
+                in_place = can_coarsen(cba);
+        }
+
+        bool gather = false;
+        if (in_place && agglomerate_cells > 0)
+        {
+            const int nranks = num_ranks(dm.back());
+            gather = nranks > 1 && cdomain.numPts() < long(agglomerate_cells) * nranks;
+        }
+
+        if (in_place && !gather)
+        {
+            cdm = dm.back();
+            agg = 0;
+        }
+        else if (in_place)
+        {
+            cba = gathered_grids(cdomain, std::max(1L, cdomain.numPts() / agglomerate_cells));
+            cdm = DistributionMapping(cba);
+            agg = 1;
+        }
+        else
+        {
+            cba = BoxArray(cdomain);
+            cdm = DistributionMapping(cba);
+            agg = (ba.back().size() > 1) ? 1 : 0;
+            if (!agg)
+                cdm = dm.back();
+        }
+
+        Array<Real> cdx(dx.back());
+        for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+            cdx[dir] *= 2;
+
+        ba.push_back(cba);
+        dm.push_back(cdm);
+        domain.push_back(cdomain);
+        dx.push_back(cdx);
+        agglomerated.push_back(agg);
+    }
+
+    nlevs = ba.size();
+
+    // Only the given grids, and the coarsest level, can fail to coarsen
+    coarsenable.resize(nlevs);
+    for (int lev = 0; lev < nlevs; ++lev)
+        coarsenable[lev] = can_coarsen(ba[lev]);
+
+    ngrow = (order == 4) ? 2 : 1;
+
+    if (single_precision)
+        define_levels(flevels);
+    else
+        define_levels(dlevels);
+
+    if (verbose > 1 && ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "GeometricMG: " << nlevs << " levels, coarsest domain "
+                  << domain.back() << (single_precision ? ", single precision" : "") << '\n';
+    }
+}
+
+template <class T>
+void
+GeometricMG::define_levels (Levels<T>& L)
+{
+    typedef typename Levels<T>::MF MF;
+
+    L.sol.resize(nlevs);
+    L.sol_prev.resize(nlevs);
+    L.sol_next.resize(nlevs);
+    L.rhs.resize(nlevs);
+    L.res.resize(nlevs);
+
+    for (int lev = 0; lev < nlevs; ++lev)
+    {
+        L.sol     [lev].reset(new MF(ba[lev], dm[lev], 1, ngrow));
+        L.sol_prev[lev].reset(new MF(ba[lev], dm[lev], 1, ngrow));
+        L.sol_next[lev].reset(new MF(ba[lev], dm[lev], 1, ngrow));
+        L.rhs     [lev].reset(new MF(ba[lev], dm[lev], 1, ngrow));
+        L.res     [lev].reset(new MF(ba[lev], dm[lev], 1, 0));
+        L.sol[lev]->setVal(0.0);
+        L.sol_prev[lev]->setVal(0.0);
+        L.sol_next[lev]->setVal(0.0);
+    }
+}
+
+Periodicity
+GeometricMG::periodicity (int lev) const
+{
+    IntVect period(IntVect::TheZeroVector());
+    for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+        if (bc[2*dir] == Periodic)
+            period[dir] = domain[lev].length(dir);
+    return Periodicity(period);
+}
+
+template <class MF>
+void
+GeometricMG::fill_ghosts (MF& mf, int lev, int homog)
+{
+    mf.FillBoundary(periodicity(lev));
+
+    if (all_periodic)
+        return;
+
+    BL_ASSERT(homog || (lev == 0 && bndry));
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        const FArrayBox* bfab = homog ? 0 : &(*bndry)[mfi];
+        gmg_fill_bc(mfi.validbox(), domain[lev], mf[mfi], bfab, bc);
+    }
+}
+
+template <class MF>
+void
+GeometricMG::residual (MF& r, MF& x, const MF& b, int lev, int homog)
+{
+    fill_ghosts(x, lev, homog);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(r,true); mfi.isValid(); ++mfi)
+        gmg_residual(mfi.tilebox(), r[mfi], x[mfi], b[mfi], dx[lev].dataPtr(), order);
+}
+
+//
+// One application of the Chebyshev polynomial of degree cheby_degree in
+// D^-1 A, targeting the upper eighth of its spectrum [lambda_max/8, lambda_max]
+// where the coarse grid correction does not reach.
+//
+template <class T>
+void
+GeometricMG::smooth (Levels<T>& L, int lev)
+{
+    const Real beta  = lambda_max;
+    const Real alpha = 0.125 * lambda_max;
+    const Real theta = 0.5 * (beta + alpha);
+    const Real delta = 0.5 * (beta - alpha);
+    const Real sigma = theta / delta;
+
+    Real rho_old = 1.0 / sigma;
+
+    for (int k = 0; k < cheby_degree; ++k)
+    {
+        Real c1, c2;
+        if (k == 0)
+        {
+            c1 = 0;
+            c2 = 1.0 / theta;
+        }
+        else
+        {
+            const Real rho = 1.0 / (2.0*sigma - rho_old);
+            c1 = rho * rho_old;
+            c2 = 2.0 * rho / delta;
+            rho_old = rho;
+        }
+
+        typename Levels<T>::MF& x = *L.sol[lev];
+        fill_ghosts(x, lev, 1);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(x,true); mfi.isValid(); ++mfi)
+        {
+            gmg_cheby(mfi.tilebox(),
+                      (*L.sol_next[lev])[mfi], x[mfi], (*L.sol_prev[lev])[mfi], (*L.rhs[lev])[mfi],
+                      dx[lev].dataPtr(), order, c1, c2);
+        }
+
+        // prev <- x <- next
+        std::swap(L.sol_prev[lev], L.sol[lev]);
+        std::swap(L.sol[lev], L.sol_next[lev]);
+    }
+}
+
+//
+// rhs at lev+1 = the restriction of fine, which lives on the grids at lev.
+// If those grids cannot be coarsened by 2, which can only happen when the
+// next level is the agglomerated domain, fine goes through one box of the
+// whole domain on the rank that holds the coarse level.
+//
+template <class T>
+void
+GeometricMG::restrict_to (Levels<T>& L, const typename Levels<T>::MF& fine, int lev)
+{
+    typedef typename Levels<T>::MF MF;
+
+    MF& crse = *L.rhs[lev+1];
+
+    const MF* src = &fine;
+    std::unique_ptr<MF> ftmp;
+    if (!coarsenable[lev])
+    {
+        BL_ASSERT(agglomerated[lev+1]);
+        ftmp.reset(new MF(BoxArray(domain[lev]), dm[lev+1], 1, 0));
+        ftmp->copy(fine);
+        src = ftmp.get();
+    }
+
+    std::unique_ptr<MF> tmp;
+    MF* dst = &crse;
+    if (agglomerated[lev+1] && coarsenable[lev])
+    {
+        tmp.reset(new MF(BoxArray(ba[lev]).coarsen(2), dm[lev], 1, 0));
+        dst = tmp.get();
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(*dst,true); mfi.isValid(); ++mfi)
+        gmg_restrict(mfi.tilebox(), (*dst)[mfi], (*src)[mfi]);
+
+    if (tmp)
+        crse.copy(*tmp);
+}
+
+//
+// sol at lev += (or = if add is 0) the interpolation of sol at lev+1.
+// The stencil reaches the diagonal neighbours, so all the ghost cells of
+// the coarse data are filled first.
+//
+template <class T>
+void
+GeometricMG::interpolate (Levels<T>& L, int lev, int add)
+{
+    typedef typename Levels<T>::MF MF;
+
+    MF* crse = L.sol[lev+1].get();
+
+    std::unique_ptr<MF> tmp;
+    if (agglomerated[lev+1] && coarsenable[lev])
+    {
+        tmp.reset(new MF(BoxArray(ba[lev]).coarsen(2), dm[lev], 1, 1));
+        tmp->setVal(0.0);
+        tmp->copy(*crse);
+        crse = tmp.get();
+    }
+
+    fill_ghosts(*crse, lev+1, 1);
+
+    MF& fine = *L.sol[lev];
+
+    // As in restrict_to, through one box of the whole domain
+    std::unique_ptr<MF> ftmp;
+    MF* dst = &fine;
+    if (!coarsenable[lev])
+    {
+        ftmp.reset(new MF(BoxArray(domain[lev]), dm[lev+1], 1, 0));
+        dst = ftmp.get();
+    }
+
+    const int dst_add = ftmp ? 0 : add;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(*dst,true); mfi.isValid(); ++mfi)
+        gmg_interp(mfi.tilebox(), (*dst)[mfi], (*crse)[mfi], dst_add);
+
+    if (ftmp)
+    {
+        MF cor(ba[lev], dm[lev], 1, 0);
+        cor.copy(*ftmp);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(fine,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            BaseFab<T>& ffab = fine[mfi];
+            const BaseFab<T>& cfab = cor[mfi];
+            if (add)
+                ffab.plus(cfab, bx, bx, 0, 0, 1);
+            else
+                ffab.copy(cfab, bx);
+        }
+    }
+}
+
+void
+GeometricMG::subtract_mean (MultiFab& mf, int lev)
+{
+    const Real mean = mf.sum(0) / domain[lev].d_numPts();
+    mf.plus(-mean, 0, 1, 0);
+}
+
+//
+// Conjugate gradients for A x = b on the coarsest level until the residual
+// has dropped by 1.e-4.  That level can still be sizeable (a 100^3 domain
+// stops at 25^3), so smoothing alone would not get there.  With homogeneous
+// boundaries the operator is symmetric, and definite except when periodic,
+// where b is made to have zero mean first.
+//
+void
+GeometricMG::cg_solve (MultiFab& x, MultiFab& b, int lev)
+{
+    const int max_iter = 1000;
+
+    if (all_periodic)
+        subtract_mean(b, lev);
+
+    MultiFab r(ba[lev], dm[lev], 1, 0);
+    MultiFab p(ba[lev], dm[lev], 1, x.nGrow());
+    MultiFab q(ba[lev], dm[lev], 1, 0);
+    MultiFab zero(ba[lev], dm[lev], 1, 0);
+    zero.setVal(0.0);
+
+    x.setVal(0.0);
+    p.setVal(0.0);
+    MultiFab::Copy(r, b, 0, 0, 1, 0);
+    MultiFab::Copy(p, r, 0, 0, 1, 0);
+
+    const Real rnorm0 = r.norm0();
+    Real rnorm = rnorm0;
+    Real rho   = MultiFab::Dot(r, 0, r, 0, 1, 0);
+
+    int n = 0;
+    for ( ; n < max_iter && rnorm > 1.e-4 * rnorm0; ++n)
+    {
+        // q = -A p
+        residual(q, p, zero, lev, 1);
+
+        const Real pAp = -MultiFab::Dot(p, 0, q, 0, 1, 0);
+        if (pAp <= 0)
+            break;
+
+        const Real alpha = rho / pAp;
+        MultiFab::Saxpy(x, alpha, p, 0, 0, 1, 0);
+        MultiFab::Saxpy(r, alpha, q, 0, 0, 1, 0);
+
+        rnorm = r.norm0();
+
+        const Real rho_new = MultiFab::Dot(r, 0, r, 0, 1, 0);
+        p.mult(rho_new / rho, 0, 1, 0);
+        MultiFab::Add(p, r, 0, 0, 1, 0);
+        rho = rho_new;
+    }
+
+    if (verbose > 1 && ParallelDescriptor::IOProcessor())
+        std::cout << "GeometricMG: bottom solve " << n << " iterations, residual "
+                  << rnorm << " (relative " << (rnorm0 > 0 ? rnorm / rnorm0 : 0) << ")\n";
+
+    if (all_periodic)
+        subtract_mean(x, lev);
+}
+
+void
+GeometricMG::bottom_solve (Levels<Real>& L)
+{
+    const int lev = nlevs-1;
+    cg_solve(*L.sol[lev], *L.rhs[lev], lev);
+}
+
+//
+// The coarsest level is small, so its solve is done in double precision
+// and only the result is rounded.
+//
+void
+GeometricMG::bottom_solve (Levels<float>& L)
+{
+    const int lev = nlevs-1;
+
+    MultiFab x(ba[lev], dm[lev], 1, ngrow);
+    MultiFab b(ba[lev], dm[lev], 1, 0);
+    copy_valid(b, *L.rhs[lev]);
+
+    cg_solve(x, b, lev);
+
+    copy_valid(*L.sol[lev], x);
+}
+
+template <class T>
+void
+GeometricMG::vcycle (Levels<T>& L, int lev)
+{
+    if (lev == nlevs-1)
+    {
+        bottom_solve(L);
+        return;
+    }
+
+    smooth(L, lev);
+
+    residual(*L.res[lev], *L.sol[lev], *L.rhs[lev], lev, 1);
+    restrict_to(L, *L.res[lev], lev);
+    L.sol[lev+1]->setVal(0.0);
+
+    vcycle(L, lev+1);
+
+    interpolate(L, lev, 1);
+
+    smooth(L, lev);
+}
+
+template <class T>
+void
+GeometricMG::fmg (Levels<T>& L)
+{
+    for (int lev = 0; lev < nlevs-1; ++lev)
+        restrict_to(L, *L.rhs[lev], lev);
+
+    bottom_solve(L);
+
+    for (int lev = nlevs-2; lev >= 0; --lev)
+    {
+        interpolate(L, lev, 0);
+        vcycle(L, lev);
+    }
+}
+
+//
+// The residual of u and the corrections added to it are in double
+// precision; each cycle solves A e = r on the levels of L, which is
+// iterative refinement when those are in float.
+//
+template <class T>
+int
+GeometricMG::cycle (Levels<T>& L, MultiFab& u, const MultiFab& f,
+                    Real target, Real& rnorm, int max_iter, int use_fmg)
+{
+    MultiFab r(ba[0], dm[0], 1, 0);
+
+    residual(r, u, f, 0, 0);
+    rnorm = r.norm0();
+
+    if (verbose > 1 && ParallelDescriptor::IOProcessor())
+        std::cout << "GeometricMG: initial residual " << rnorm
+                  << ", target " << target << '\n';
+
+    int iter = 0;
+    while (rnorm > target && iter < max_iter)
+    {
+        copy_valid(*L.rhs[0], r);
+
+        if (iter == 0 && use_fmg)
+        {
+            fmg(L);
+        }
+        else
+        {
+            L.sol[0]->setVal(0.0);
+            vcycle(L, 0);
+        }
+
+        add_valid(u, *L.sol[0]);
+
+        residual(r, u, f, 0, 0);
+        rnorm = r.norm0();
+        iter++;
+
+        if (verbose > 1 && ParallelDescriptor::IOProcessor())
+            std::cout << "GeometricMG: iteration " << iter << ", residual " << rnorm << '\n';
+    }
+
+    return iter;
+}
+
+Real
+GeometricMG::solve (MultiFab&       phi,
+                    const MultiFab& b,
+                    Real            tol,
+                    Real            abs_tol,
+                    int             max_iter,
+                    int             use_fmg)
+{
+    const Real strt = ParallelDescriptor::second();
+
+    BL_ASSERT(phi.boxArray() == ba[0]);
+
+    // Keep the boundary values before the ghost cells get overwritten
+    bndry.reset(new MultiFab(ba[0], dm[0], 1, std::min(ngrow, phi.nGrow())));
+    MultiFab::Copy(*bndry, phi, 0, 0, 1, bndry->nGrow());
+
+    // The discrete right-hand side, with the Mehrstellen correction at order 4
+    MultiFab f(ba[0], dm[0], 1, 1);
+    MultiFab::Copy(f, b, 0, 0, 1, 0);
+    if (order == 4)
+    {
+        f.FillBoundary(periodicity(0));
+        MultiFab f4(ba[0], dm[0], 1, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(f4,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            FORT_GMG_RHS4(bx.loVect(), bx.hiVect(),
+                          BL_TO_FORTRAN(f4[mfi]), BL_TO_FORTRAN(f[mfi]));
+        }
+        MultiFab::Copy(f, f4, 0, 0, 1, 0);
+    }
+
+    // The solution, whose corrections come from solving A e = r on all levels
+    MultiFab u(ba[0], dm[0], 1, ngrow);
+    u.setVal(0.0);
+    MultiFab::Copy(u, phi, 0, 0, 1, 0);
+
+    const Real bnorm  = b.norm0();
+    const Real target = std::max(tol * bnorm, abs_tol);
+
+    Real rnorm;
+    const int iter = single_precision
+        ? cycle(flevels, u, f, target, rnorm, max_iter, use_fmg)
+        : cycle(dlevels, u, f, target, rnorm, max_iter, use_fmg);
+
+    if (rnorm > target)
+        amrex::Error("GeometricMG: failed to converge");
+
+    MultiFab::Copy(phi, u, 0, 0, 1, 0);
+    phi.FillBoundary(periodicity(0));
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+    {
+        const Real end = ParallelDescriptor::second() - strt;
+        std::cout << "GeometricMG: " << iter << " cycles, residual " << rnorm
+                  << " (relative " << (bnorm > 0 ? rnorm / bnorm : 0) << ")"
+                  << " in " << end << " s\n";
+    }
+
+    return rnorm;
+}
+
+void
+GeometricMG::get_grad_phi (const MultiFab& phi, const Array<MultiFab*>& grad_phi)
+{
+    BL_ASSERT(grad_phi.size() == BL_SPACEDIM);
+
+    MultiFab u(ba[0], dm[0], 1, ngrow);
+    u.setVal(0.0);
+    MultiFab::Copy(u, phi, 0, 0, 1, 0);
+    fill_ghosts(u, 0, 0);
+
+    for (int dir = 0; dir < BL_SPACEDIM; ++dir)
+    {
+        MultiFab& grad = *grad_phi[dir];
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(grad,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            FORT_GMG_GRAD(bx.loVect(), bx.hiVect(),
+                          BL_TO_FORTRAN(grad[mfi]),
+                          BL_TO_FORTRAN(u[mfi]),
+                          dx[0].dataPtr(), &dir, &order);
+        }
+    }
+}
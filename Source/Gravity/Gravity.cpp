@@ -13,6 +13,7 @@
 #include <AMReX_MGT_Solver.H>
 #include <AMReX_stencil_types.H>
 #include <mg_cpp_f.h>
+#include "GeometricMG.H"
 
 #ifdef USEHPGMG
 #include <BL_HPGMG.H>
@@ -31,11 +32,33 @@ int  Gravity::no_sync       = 0;
 int  Gravity::no_composite  = 0;
 int  Gravity::dirichlet_bcs = 0;
 int  Gravity::monopole_bcs  = 0;
+int  Gravity::max_multipole_order = -1;
+int  Gravity::phi_guess_order = 0;
+int  Gravity::phi_guess_in_a  = 1;
 int  Gravity::solve_with_cpp= 0;
 int  Gravity::solve_with_hpgmg = 0;
+int  Gravity::solve_with_gmg   = 0;
+int  Gravity::gmg_order        = 2;
+int  Gravity::gmg_cheby_degree = 4;
+int  Gravity::gmg_max_iter     = 50;
+int  Gravity::gmg_use_fmg      = 1;
+int  Gravity::gmg_single_precision = 0;
 Real Gravity::sl_tol        = 1.e-12;
 Real Gravity::ml_tol        = 1.e-12;
 Real Gravity::delta_tol     = 1.e-12;
+int  Gravity::adaptive_tol  = 0;
+Real Gravity::adaptive_tol_fraction = 0.1;
+Real Gravity::adaptive_tol_max      = 1.e-4;
+int  Gravity::agglomerate_cells_per_rank = 0;
+Real Gravity::short_range_rs         = 0;
+Real Gravity::short_range_rcut       = 4.5;
+Real Gravity::short_range_eps        = 0.05;
+Real Gravity::sync_skip_fraction     = 0;
+Real Gravity::sync_max_tol           = 1.e-3;
+int  Gravity::reuse_old_phi          = 0;
+int  Gravity::neutrino_deposit_ratio    = 1;
+Real Gravity::neutrino_smooth_sigma     = 1.0;
+int  Gravity::neutrino_deposit_interval = 1;
 Real Gravity::mass_offset   = 0;
 int  Gravity::stencil_type  = CC_CROSS_STENCIL;
 
@@ -75,6 +98,12 @@ Gravity::Gravity (Amr*   Parent,
     grids(Parent->boxArray()),
     dmap(Parent->DistributionMap()),
     level_solver_resnorm(MAX_LEV),
+    level_rhs_norm(MAX_LEV,0),
+    sync_skipped_norm(MAX_LEV,0),
+    phi_new_current(0),
+    multipole_valid(false),
+    phi_history(MAX_LEV),
+    phi_history_x(MAX_LEV),
     phys_bc(_phys_bc)
 {
      density = _density;
@@ -127,13 +156,46 @@ Gravity::read_params ()
 
         pp.query("dirichlet_bcs", dirichlet_bcs);
         pp.query("monopole_bcs"  , monopole_bcs);
+        // With monopole_bcs, phi outside the domain is -G m / r summed exactly
+        // over the dark matter particles, unless this is >= 0, when a multipole
+        // expansion to that order of the gas and particles is used wherever it
+        // converges on the domain faces
+        pp.query("max_multipole_order", max_multipole_order);
+
+        if (max_multipole_order < -1)
+            amrex::Error("gravity.max_multipole_order must be >= -1");
+
+        // Initial guess for the new-phi solves: 0 is the old phi, 1 and 2
+        // extrapolate linearly or quadratically in a (or t if phi_guess_in_a = 0)
+        pp.query("phi_guess_order", phi_guess_order);
+        pp.query("phi_guess_in_a", phi_guess_in_a);
+
+        if (phi_guess_order < 0 || phi_guess_order > 2)
+            amrex::Error("gravity.phi_guess_order must be 0, 1 or 2");
 
         pp.query("solve_with_cpp", solve_with_cpp);
         pp.query("solve_with_hpgmg", solve_with_hpgmg);
 
-        if (solve_with_cpp && solve_with_hpgmg)
+        // The native geometric multigrid, for single-level solves at level 0;
+        // gmg_order = 4 uses the Mehrstellen operator (periodic, cubic cells),
+        // and gmg_single_precision = 1 runs its cycles in float, refined by
+        // a double-precision residual to the same tolerance
+        pp.query("solve_with_gmg", solve_with_gmg);
+        pp.query("gmg_order", gmg_order);
+        pp.query("gmg_cheby_degree", gmg_cheby_degree);
+        pp.query("gmg_max_iter", gmg_max_iter);
+        pp.query("gmg_use_fmg", gmg_use_fmg);
+        pp.query("gmg_single_precision", gmg_single_precision);
+
+        if (solve_with_cpp + solve_with_hpgmg + solve_with_gmg > 1)
           amrex::Error("Multiple gravity solvers selected.");
 
+        if (gmg_order != 2 && gmg_order != 4)
+          amrex::Error("gravity.gmg_order must be 2 or 4");
+
+        if (solve_with_gmg && gmg_order == 4 && !Geometry::isAllPeriodic())
+          amrex::Error("gravity.gmg_order = 4 needs a periodic domain");
+
 #ifndef USEHPGMG
         if (solve_with_hpgmg)
           amrex::Error("To use the HPGMG solver you must compile with USE_HPGMG = TRUE");
@@ -144,6 +206,70 @@ Gravity::read_params ()
         pp.query("sl_tol", sl_tol);
         pp.query("delta_tol", delta_tol);
 
+        // Stop the solves at adaptive_tol_fraction of the estimated truncation
+        // error instead (but never looser than adaptive_tol_max); the fixed
+        // tolerances above remain a floor and are all that is used otherwise
+        pp.query("adaptive_tol", adaptive_tol);
+        pp.query("adaptive_tol_fraction", adaptive_tol_fraction);
+        pp.query("adaptive_tol_max", adaptive_tol_max);
+
+        // Gather coarse levels with fewer than this many cells per rank onto
+        // fewer ranks (0 = never).  This is meant for solve_with_gmg, where
+        // every coarse MG level is gathered; the default MGT solver only sees
+        // a level-0 that is itself that small and leaves its coarse MG levels
+        // where they are
+        pp.query("agglomerate_cells_per_rank", agglomerate_cells_per_rank);
+
+        // Split the dark matter force at short_range_rs level-0 cells: the mesh
+        // sees a Gaussian-smoothed density and the rest is summed directly over
+        // pairs closer than short_range_rcut * short_range_rs, with a Plummer
+        // softening of short_range_eps cells (0 = mesh force only)
+        pp.query("short_range_rs", short_range_rs);
+        pp.query("short_range_rcut", short_range_rcut);
+        pp.query("short_range_eps", short_range_eps);
+
+        // Skip a gravity_sync solve while the norms of the sync rhs skipped
+        // since the last one, this one included, stay below sync_skip_fraction
+        // of the last phi rhs (the skipped mass is in the next phi solves
+        // anyway); otherwise solve only as accurately as that phi solve
+        // needs, but to no worse than sync_max_tol.  With the default
+        // sync_skip_fraction = 0 every sync is solved to delta_tol.
+        pp.query("sync_skip_fraction", sync_skip_fraction);
+        pp.query("sync_max_tol", sync_max_tol);
+
+        if (sync_skip_fraction < 0 || sync_max_tol <= 0 || sync_max_tol >= 1)
+            amrex::Error("gravity.sync_skip_fraction must be >= 0 and sync_max_tol in (0,1)");
+
+        // Take the old phi for a coarse step from the new phi of the last one
+        // when that was a composite solve on the same grids and nothing but a
+        // (solved) gravity_sync has changed the state since
+        pp.query("reuse_old_phi", reuse_old_phi);
+
+        // Deposit the neutrinos on the cells of each level coarsened by
+        // neutrino_deposit_ratio (1 to 4), smooth them there with a Gaussian
+        // of neutrino_smooth_sigma coarse cells if the ratio is above 1 and
+        // interpolate them back, redoing this only every
+        // neutrino_deposit_interval level steps; with the ratio and interval
+        // at 1 the neutrinos are deposited as the dark matter is
+        pp.query("neutrino_deposit_ratio", neutrino_deposit_ratio);
+        pp.query("neutrino_smooth_sigma", neutrino_smooth_sigma);
+        pp.query("neutrino_deposit_interval", neutrino_deposit_interval);
+
+        if (neutrino_deposit_ratio < 1 || neutrino_deposit_ratio > 4)
+            amrex::Error("gravity.neutrino_deposit_ratio must be between 1 and 4");
+        if (neutrino_deposit_interval < 1 || neutrino_smooth_sigma < 0)
+            amrex::Error("gravity.neutrino_deposit_interval must be >= 1 and neutrino_smooth_sigma >= 0");
+
+        if (short_range_rs > 0)
+        {
+            int max_level = 0;
+            ParmParse("amr").query("max_level", max_level);
+            if (max_level > 0)
+                amrex::Error("gravity.short_range_rs requires amr.max_level = 0");
+            if (short_range_rcut <= 0 || short_range_eps < 0)
+                amrex::Error("gravity.short_range_rcut must be > 0 and short_range_eps >= 0");
+        }
+
         Real Gconst;
         fort_get_grav_const(&Gconst);
         Ggravity = -4.0 * M_PI * Gconst;
@@ -185,6 +311,13 @@ Gravity::install_level (int       level,
     LevelData[level] = level_data_to_install;
 
     level_solver_resnorm[level] = 0;
+    level_rhs_norm[level]       = 0;
+    sync_skipped_norm[level]    = 0;
+    phi_new_current             = 0;
+
+    // The grids have changed, so the old potentials are of no use
+    phi_history[level].clear();
+    phi_history_x[level].clear();
 
 #ifdef CGRAV
     if (gravity_type != "StaticGrav")
@@ -239,6 +372,18 @@ Gravity::get_no_composite ()
     return no_composite;
 }
 
+int
+Gravity::get_reuse_old_phi ()
+{
+    return reuse_old_phi;
+}
+
+void
+Gravity::mark_phi_new_stale ()
+{
+    phi_new_current = 0;
+}
+
 Array<MultiFab*>
 Gravity::get_grad_phi_prev (int level)
 {
@@ -354,7 +499,20 @@ Gravity::solve_for_new_phi (int               level,
     AddGhostParticlesToRhs(level,Rhs);
 
     const Real time = LevelData[level]->get_state_data(PhiGrav_Type).curTime();
+
+    std::unique_ptr<MultiFab> guess;
+    if (extrapolate_phi_guess(level, phi, time) && verbose)
+    {
+        guess.reset(new MultiFab(grids[level], dmap[level], 1, 0));
+        MultiFab::Copy(*guess, phi, 0, 0, 1, 0);
+    }
+
     solve_for_phi(level, Rhs, phi, grad_phi, time, fill_interior);
+
+    if (guess)
+        report_phi_guess(level, phi, *guess);
+
+    phi_new_current = (level == 0 && parent->finestLevel() == 0);
 }
 
 void
@@ -406,6 +564,7 @@ Gravity::solve_for_phi (int               level,
 #endif
 
     // Need to set the boundary values here so they can get copied into "bndry"
+    if (dirichlet_bcs && monopole_bcs && max_multipole_order >= 0) compute_multipole_moments(time);
     if (dirichlet_bcs) set_dirichlet_bcs(level,&phi);
 
     if (level == 0)
@@ -479,9 +638,12 @@ Gravity::solve_for_phi (int               level,
     Array<MultiFab*> phi_p = { &phi };
     Array<MultiFab*> Rhs_p = { &Rhs };
 
-    const Real  tol     = sl_tol;
+    Real        rhs_norm;
+    const Real  tol     = solver_tolerance(Rhs_p, sl_tol, rhs_norm);
     const Real  abs_tol = 0.;
 
+    level_rhs_norm[level] = rhs_norm * cs->get_comoving_a(time);
+
     if (solve_with_cpp)
     {
         solve_with_Cpp(level, phi, grad_phi, Rhs, tol, abs_tol);
@@ -492,19 +654,81 @@ Gravity::solve_for_phi (int               level,
         solve_with_HPGMG(level, phi, grad_phi, Rhs, tol, abs_tol);
 #endif
     }
+    else if (solve_with_gmg && level == 0)
+    {
+        level_solver_resnorm[level] = solve_with_GMG(level, phi, grad_phi, Rhs, tol, abs_tol);
+    }
     else
     {
-        MGT_Solver mgt_solver(fgeom, mg_bc, bav, dmv, false, stencil_type);
-        mgt_solver.set_const_gravity_coeffs(xa, xb);
         const int   mglev   = 0;
         const Real* dx      = geom.CellSize();
 
+        //
+        // With too few cells per rank, solve on a copy of the level
+        // distributed over fewer, larger grids instead.
+        //
+        MultiFab*        phi_s   = &phi;
+        MultiFab*        Rhs_s   = &Rhs;
+        MacBndry*        bndry_s = &bndry;
+        Array<MultiFab*> grad_s  = grad_phi;
+
+        std::unique_ptr<MultiFab> phi_agg, Rhs_agg;
+        std::unique_ptr<MacBndry> bndry_agg;
+        Array<std::unique_ptr<MultiFab> > grad_agg(BL_SPACEDIM);
+
+        BoxArray agg_ba;
+        if (agglomerated_grids(level, agg_ba))
+        {
+            DistributionMapping agg_dm(agg_ba);
+
+            // The ghost cells carry the Dirichlet values, if any
+            phi_agg.reset(new MultiFab(agg_ba, agg_dm, 1, phi.nGrow()));
+            phi_agg->setVal(0.0);
+            phi_agg->copy(phi, 0, 0, 1, phi.nGrow(), phi.nGrow());
+
+            Rhs_agg.reset(new MultiFab(agg_ba, agg_dm, 1, 0));
+            Rhs_agg->copy(Rhs);
+
+            bndry_agg.reset(new MacBndry(agg_ba, agg_dm, 1, geom));
+            bndry_agg->setBndryValues(*phi_agg, src_comp, dest_comp, num_comp, *phys_bc);
+
+            for (int n = 0; n < BL_SPACEDIM; ++n)
+            {
+                grad_agg[n].reset(new MultiFab(BoxArray(agg_ba).surroundingNodes(n), agg_dm, 1, 0));
+                grad_s[n] = grad_agg[n].get();
+            }
+
+            phi_s   = phi_agg.get();
+            Rhs_s   = Rhs_agg.get();
+            bndry_s = bndry_agg.get();
+
+            bav[0] = agg_ba;
+            dmv[0] = agg_dm;
+            phi_p[0] = phi_s;
+            Rhs_p[0] = Rhs_s;
+        }
+
+        MGT_Solver mgt_solver(fgeom, mg_bc, bav, dmv, false, stencil_type);
+        mgt_solver.set_const_gravity_coeffs(xa, xb);
+
 	int always_use_bnorm = 0;
 	int need_grad_phi = 1;
-        mgt_solver.solve(phi_p, Rhs_p, bndry, tol, abs_tol, always_use_bnorm,
-			 level_solver_resnorm[level], need_grad_phi);
 
-        mgt_solver.get_fluxes(mglev, grad_phi, dx);
+        mgt_solver.solve(phi_p, Rhs_p, *bndry_s, tol, abs_tol, always_use_bnorm,
+                         level_solver_resnorm[level], need_grad_phi);
+        mgt_solver.get_fluxes(mglev, grad_s, dx);
+
+        if (phi_agg)
+        {
+            phi.copy(*phi_agg);
+            for (int n = 0; n < BL_SPACEDIM; ++n)
+                grad_phi[n]->copy(*grad_agg[n]);
+        }
+
+        if (verbose && ParallelDescriptor::IOProcessor())
+            std::cout << " ... final residual at level " << level << ": "
+                      << level_solver_resnorm[level] << " (relative "
+                      << level_solver_resnorm[level] / rhs_norm << ")" << '\n';
     }
 
     if (show_timings)
@@ -529,7 +753,8 @@ Gravity::solve_for_delta_phi (int                        crse_level,
                               int                        fine_level,
                               MultiFab&                  crse_rhs,
                               const Array<MultiFab*>&         delta_phi,
-                              const Array<Array<MultiFab*> >& grad_delta_phi)
+                              const Array<Array<MultiFab*> >& grad_delta_phi,
+                              Real                            min_tol)
 {
     const int num_levels = fine_level - crse_level + 1;
     const Box& crse_domain = (parent->Geom(crse_level)).Domain();
@@ -639,7 +864,8 @@ Gravity::solve_for_delta_phi (int                        crse_level,
 
     mgt_solver.set_const_gravity_coeffs(xa, xb);
 
-    const Real tol     = delta_tol;
+    Real       rhs_norm;
+    const Real tol     = std::max(solver_tolerance(Rhs_p, delta_tol, rhs_norm), min_tol);
     Real       abs_tol = level_solver_resnorm[crse_level];
     for (int lev = crse_level + 1; lev < fine_level; lev++)
         abs_tol = std::max(abs_tol,level_solver_resnorm[lev]);
@@ -649,6 +875,10 @@ Gravity::solve_for_delta_phi (int                        crse_level,
     int need_grad_phi = 1;
     mgt_solver.solve(delta_phi, Rhs_p, bndry, tol, abs_tol, always_use_bnorm, final_resnorm, need_grad_phi);
 
+    if (verbose && ParallelDescriptor::IOProcessor())
+        std::cout << " ... final residual of the delta phi solve: "
+                  << final_resnorm << " (relative " << final_resnorm / rhs_norm << ")" << '\n';
+
     for (int lev = crse_level; lev <= fine_level; lev++)
     {
         auto& gdphi = grad_delta_phi[lev-crse_level];
@@ -698,6 +928,48 @@ Gravity::gravity_sync (int crse_level, int fine_level, int iteration, int ncycle
         crse_rhs.plus(-local_correction,0,1,0);
     }
 
+    Real min_tol = 0;
+
+    if (sync_skip_fraction > 0)
+    {
+        // Compare with the rhs of the phi solves at these levels, which
+        // (unlike this one) are divided by a
+        Real ref_norm = 0;
+        for (int lev = crse_level; lev <= fine_level; lev++)
+            ref_norm = std::max(ref_norm, level_rhs_norm[lev]);
+
+        const Real sync_norm = crse_rhs.norm0();
+        const Real skipped   = sync_skipped_norm[crse_level] + sync_norm;
+
+        if (ref_norm > 0 && skipped <= sync_skip_fraction * ref_norm)
+        {
+            sync_skipped_norm[crse_level] = skipped;
+
+            if (verbose && ParallelDescriptor::IOProcessor())
+                std::cout << " ... skipping gravity_sync at crse_level " << crse_level
+                          << ": sync rhs " << sync_norm / ref_norm << " of the phi rhs, "
+                          << skipped / ref_norm << " since the last sync solve" << '\n';
+
+            for (int lev = crse_level; lev <= fine_level; lev++)
+                grad_delta_phi_cc[lev-crse_level]->setVal(0.0);
+
+            // phi_new is now behind the refluxed state
+            phi_new_current = 0;
+            return;
+        }
+
+        sync_skipped_norm[crse_level] = 0;
+
+        // delta_phi only needs the absolute accuracy of the phi solves
+        if (sync_norm > 0)
+            min_tol = std::min(sync_max_tol, delta_tol * ref_norm / sync_norm);
+
+        if (verbose && ParallelDescriptor::IOProcessor())
+            std::cout << " ...     sync rhs " << (ref_norm > 0 ? sync_norm / ref_norm : 0)
+                      << " of the phi rhs, solving to relative tol " << std::max(min_tol, delta_tol)
+                      << '\n';
+    }
+
     // delta_phi needs a ghost cell for the solve
     Array<std::unique_ptr<MultiFab> >  delta_phi(fine_level - crse_level + 1);
     for (int lev = crse_level; lev <= fine_level; lev++)
@@ -719,7 +991,7 @@ Gravity::gravity_sync (int crse_level, int fine_level, int iteration, int ncycle
     // Do multi-level solve for delta_phi
     solve_for_delta_phi(crse_level, fine_level, crse_rhs, 
 			amrex::GetArrOfPtrs(delta_phi),
-			amrex::GetArrOfArrOfPtrs(ec_gdPhi));
+			amrex::GetArrOfArrOfPtrs(ec_gdPhi), min_tol);
 
     crse_rhs.clear();
 
@@ -899,6 +1171,8 @@ Gravity::multilevel_solve_for_new_phi (int level,
     actual_multilevel_solve(level, finest_level, 
 			    amrex::GetArrOfArrOfPtrs(grad_phi_curr),
                             is_new, use_previous_phi_as_guess);
+
+    phi_new_current = (level == 0 && finest_level == parent->finestLevel());
 }
 
 void
@@ -906,6 +1180,22 @@ Gravity::multilevel_solve_for_old_phi (int level,
                                        int finest_level,
                                        int use_previous_phi_as_guess)
 {
+    // After swap_time_levels the old phi and grad_phi_prev are the last new
+    // ones, which a solve would only reproduce to within the tolerance
+    const bool reuse = reuse_old_phi && phi_new_current && level == 0 &&
+                       finest_level == parent->finestLevel() &&
+                       (no_sync == 0 || finest_level == 0);
+
+    phi_new_current = 0;
+
+    if (reuse)
+    {
+        if (verbose && ParallelDescriptor::IOProcessor())
+            std::cout << "Gravity ... reusing the last new phi as the old phi up to finest level "
+                      << finest_level << '\n';
+        return;
+    }
+
     if (verbose && ParallelDescriptor::IOProcessor())
         std::cout << "Gravity ... multilevel solve for old phi at base level " << level
                   << " to finest level " << finest_level << '\n';
@@ -1024,6 +1314,7 @@ Gravity::actual_multilevel_solve (int                       level,
 
     Array<MultiFab*> phi_p(num_levels);
     Array<std::unique_ptr<MultiFab> > Rhs_p(num_levels);
+    Array<std::unique_ptr<MultiFab> > guess(num_levels);
 
     Array<std::unique_ptr<MultiFab> > Rhs_particles(num_levels);
     for (int lev = 0; lev < num_levels; lev++)
@@ -1055,6 +1346,8 @@ Gravity::actual_multilevel_solve (int                       level,
     // Here we get comoving_a b/c the RHS should be 4 * pi * G * density / a
     const Real a_inverse = 1. / (cs->get_comoving_a(time));
 
+    if (dirichlet_bcs && monopole_bcs && max_multipole_order >= 0) compute_multipole_moments(time);
+
 // *****************************************************************************
 
     for (int lev = 0; lev < num_levels; lev++)
@@ -1072,6 +1365,11 @@ Gravity::actual_multilevel_solve (int                       level,
 
         if (!use_previous_phi_as_guess)
             phi_p[lev]->setVal(0);
+        else if (is_new == 1 && extrapolate_phi_guess(level+lev, *phi_p[lev], time) && verbose)
+        {
+            guess[lev].reset(new MultiFab(grids[level+lev], dmap[level+lev], 1, 0));
+            MultiFab::Copy(*guess[lev], *phi_p[lev], 0, 0, 1, 0);
+        }
 
         // Need to set the boundary values before "bndry" is defined so they get copied in
         if (dirichlet_bcs) set_dirichlet_bcs(level+lev,phi_p[lev]);
@@ -1219,9 +1517,12 @@ Gravity::actual_multilevel_solve (int                       level,
         ParallelDescriptor::Barrier();
     const Real strt_solve = ParallelDescriptor::second();
 
-    Real tol           = ml_tol;
+    Real rhs_norm;
+    Real tol           = solver_tolerance(amrex::GetArrOfPtrs(Rhs_p), ml_tol, rhs_norm);
     Real abs_tol       = 0;
 
+    level_rhs_norm[level] = rhs_norm / a_inverse;
+
     //
     // Can only use the C++ solvers if single-level
     //
@@ -1237,6 +1538,14 @@ Gravity::actual_multilevel_solve (int                       level,
         solve_with_HPGMG(level, *(phi_p[0]), grad_phi[0], *(Rhs_p[0]), tol, abs_tol);
 #endif
     }
+    else if ( solve_with_gmg && (level == finest_level) && (level == 0) )
+    {
+        Real final_resnorm = solve_with_GMG(level, *(phi_p[0]), grad_phi[0], *(Rhs_p[0]), tol, abs_tol);
+
+        if (verbose && ParallelDescriptor::IOProcessor())
+            std::cout << " ... final residual of the single-level solve: "
+                      << final_resnorm << " (relative " << final_resnorm / rhs_norm << ")" << '\n';
+    }
     else
     {
         MGT_Solver mgt_solver(fgeom, mg_bc, bav, dmv, false, stencil_type);
@@ -1252,6 +1561,10 @@ Gravity::actual_multilevel_solve (int                       level,
         mgt_solver.solve(phi_p, amrex::GetArrOfPtrs(Rhs_p),
 			 bndry, tol, abs_tol, always_use_bnorm, final_resnorm, need_grad_phi);
 
+        if (verbose && ParallelDescriptor::IOProcessor())
+            std::cout << " ... final residual of the multilevel solve: "
+                      << final_resnorm << " (relative " << final_resnorm / rhs_norm << ")" << '\n';
+
         for (int lev = 0; lev < num_levels; lev++)
         {
             const Real* dx = parent->Geom(level+lev).CellSize();
@@ -1267,6 +1580,10 @@ Gravity::actual_multilevel_solve (int                       level,
             std::cout << "Gravity:: time in solve          = " << end_solve << '\n';
     }
 
+    for (int lev = 0; lev < num_levels; lev++)
+        if (guess[lev])
+            report_phi_guess(level+lev, *phi_p[lev], *guess[lev]);
+
     // Average phi from fine to coarse level
     for (int lev = finest_level; lev > level; lev--)
     {
@@ -1735,6 +2052,229 @@ Gravity::make_mg_bc ()
     }
 }
 
+bool
+Gravity::extrapolate_phi_guess (int       level,
+                                MultiFab& phi,
+                                Real      time)
+{
+    if (phi_guess_order == 0)
+        return false;
+
+    BL_PROFILE("Gravity::extrapolate_phi_guess()");
+
+    Nyx* cs = dynamic_cast<Nyx*>(&parent->getLevel(level));
+    BL_ASSERT(cs != 0);
+
+    const Real prev_time = LevelData[level]->get_state_data(PhiGrav_Type).prevTime();
+    const Real x_old     = phi_guess_in_a ? cs->get_comoving_a(prev_time) : prev_time;
+    const Real x_new     = phi_guess_in_a ? cs->get_comoving_a(time)      : time;
+
+    Array<std::unique_ptr<MultiFab> >& hist   = phi_history[level];
+    Array<Real>&                       hist_x = phi_history_x[level];
+
+    //
+    // The old phi may have been changed by a sync since it was last kept, so
+    // a second solve from the same old time just refreshes the newest copy.
+    //
+    if (hist.size() == 0 || hist_x[0] != x_old)
+    {
+        if (hist.size() == phi_guess_order+1)
+        {
+            hist.pop_back();
+            hist_x.pop_back();
+        }
+        hist.insert(hist.begin(), std::unique_ptr<MultiFab>(new MultiFab(grids[level], dmap[level], 1, 0)));
+        hist_x.insert(hist_x.begin(), x_old);
+    }
+    MultiFab::Copy(*hist[0], LevelData[level]->get_old_data(PhiGrav_Type), 0, 0, 1, 0);
+
+    const int npts = hist.size();
+    if (npts < 2 || x_new == x_old)
+        return false;
+
+    // Lagrange weights of the kept potentials at x_new
+    Array<Real> w(npts,1);
+    for (int i = 0; i < npts; i++)
+        for (int j = 0; j < npts; j++)
+            if (j != i)
+                w[i] *= (x_new - hist_x[j]) / (hist_x[i] - hist_x[j]);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(phi,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        FArrayBox& fab = phi[mfi];
+
+        fab.copy((*hist[0])[mfi], bx, 0, bx, 0, 1);
+        fab.mult(w[0], bx, 0, 1);
+        for (int i = 1; i < npts; i++)
+            fab.saxpy(w[i], (*hist[i])[mfi], bx, bx, 0, 0, 1);
+    }
+
+    if (verbose > 1 && ParallelDescriptor::IOProcessor())
+        std::cout << " ... initial guess for phi at level " << level
+                  << " extrapolated from " << npts << " old solutions" << '\n';
+
+    return true;
+}
+
+//
+// Compare the extrapolated guess and the old phi (the guess it replaced)
+// with the converged phi.  The number of V-cycles saved is estimated from
+// the ratio of the two errors, assuming each V-cycle reduces the error by
+// a factor of 10.
+//
+void
+Gravity::report_phi_guess (int             level,
+                           const MultiFab& phi,
+                           const MultiFab& guess)
+{
+    MultiFab diff(grids[level], dmap[level], 1, 0);
+
+    MultiFab::Copy(diff, phi, 0, 0, 1, 0);
+    MultiFab::Subtract(diff, guess, 0, 0, 1, 0);
+    const Real err_guess = diff.norm0();
+
+    MultiFab::Copy(diff, phi, 0, 0, 1, 0);
+    MultiFab::Subtract(diff, LevelData[level]->get_old_data(PhiGrav_Type), 0, 0, 1, 0);
+    const Real err_old = diff.norm0();
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << " ... max error of the extrapolated phi guess at level " << level
+                  << ": " << err_guess << " (old phi: " << err_old << ")";
+        if (err_guess > 0 && err_old > 0)
+            std::cout << ", about " << std::log10(err_old / err_guess) << " V-cycles saved";
+        std::cout << '\n';
+    }
+}
+
+//
+// The estimate is the largest second difference of the rhs over the interior
+// of each grid, over 12 times the largest rhs, which for a smooth rhs is the
+// relative truncation error of the 7-point Laplacian and for a noisy deposit
+// is dominated by the shot noise.  Solving to well below either is wasted.
+//
+Real
+Gravity::solver_tolerance (const Array<MultiFab*>& Rhs,
+                           Real                    strict_tol,
+                           Real&                   rhs_norm)
+{
+    // Nothing uses the norm of the rhs then, so spare the reduction
+    if (!adaptive_tol && !verbose && sync_skip_fraction <= 0)
+    {
+        rhs_norm = 0;
+        return strict_tol;
+    }
+
+    const int nlevs = Rhs.size();
+
+    // max |rhs| and max second difference at each level, reduced together
+    Array<Real> norms(2*nlevs,0);
+
+    for (int lev = 0; lev < nlevs; lev++)
+    {
+        norms[2*lev] = Rhs[lev]->norm0(0, 0, true);
+
+        if (!adaptive_tol)
+            continue;
+
+        Real diff_max = 0;
+#ifdef _OPENMP
+#pragma omp parallel reduction(max:diff_max)
+#endif
+        for (MFIter mfi(*Rhs[lev],true); mfi.isValid(); ++mfi)
+        {
+            // Stay one cell inside the grid so no ghost cells are needed
+            const Box bx = mfi.tilebox() & amrex::grow(mfi.validbox(),-1);
+            if (bx.ok())
+                BL_FORT_PROC_CALL(FORT_RHS_SECOND_DIFF_MAX, fort_rhs_second_diff_max)
+                    (bx.loVect(), bx.hiVect(), BL_TO_FORTRAN((*Rhs[lev])[mfi]), &diff_max);
+        }
+        norms[2*lev+1] = diff_max;
+    }
+
+    ParallelDescriptor::ReduceRealMax(norms.dataPtr(), 2*nlevs);
+
+    // The finest level with a nonzero rhs has the smallest truncation error,
+    // and a multilevel solve has to be good enough for it
+    rhs_norm = 0;
+    Real trunc_err = -1;
+    for (int lev = 0; lev < nlevs; lev++)
+    {
+        rhs_norm = std::max(rhs_norm, norms[2*lev]);
+        if (norms[2*lev] > 0)
+        {
+            const Real err = norms[2*lev+1] / (12.0 * norms[2*lev]);
+            trunc_err = (trunc_err < 0) ? err : std::min(trunc_err, err);
+        }
+    }
+
+    if (!adaptive_tol || trunc_err < 0)
+        return strict_tol;
+
+    const Real tol = std::max(strict_tol, std::min(adaptive_tol_max, adaptive_tol_fraction * trunc_err));
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+        std::cout << " ... relative truncation error estimate " << trunc_err
+                  << ", solving to " << tol << '\n';
+
+    return tol;
+}
+
+//
+// Level 0, if it covers the domain with fewer than agglomerate_cells_per_rank
+// cells per rank, is given to the solver as the domain chopped into about
+// cells / agglomerate_cells_per_rank grids; the default distribution puts
+// each on its own rank, and a small enough level ends up on a single rank.
+// Returns false, leaving ba alone, if the grids are used as they are.  Only
+// the whole level is regridded: the MGT solver builds its own coarse levels
+// from these grids, so on a large level-0 nothing is gathered.
+//
+bool
+Gravity::agglomerated_grids (int       level,
+                             BoxArray& ba)
+{
+    if (agglomerate_cells_per_rank <= 0 || level > 0)
+        return false;
+
+    const Box&  domain = parent->Geom(level).Domain();
+    const long  ncells = domain.numPts();
+    const int   nprocs = ParallelDescriptor::NProcs();
+
+    if (grids[level].numPts() != ncells || ncells >= long(agglomerate_cells_per_rank) * nprocs)
+        return false;
+
+    const int nranks = std::max(1L, ncells / agglomerate_cells_per_rank);
+
+    // Halve the grid size while the grids still fit on nranks ranks,
+    // stopping at the blocking factor so the MG hierarchy is unchanged
+    const int min_size = parent->blockingFactor(level);
+    int max_size = domain.longside();
+    while (max_size / 2 >= min_size && max_size % 2 == 0)
+    {
+        BoxArray trial(domain);
+        trial.maxSize(max_size / 2);
+        if (trial.size() > nranks)
+            break;
+        max_size /= 2;
+    }
+
+    ba.define(domain);
+    ba.maxSize(max_size);
+
+    if (ba.size() >= grids[level].size())
+        return false;
+
+    if (verbose && ParallelDescriptor::IOProcessor())
+        std::cout << " ... solving on " << ba.size() << " grids instead of "
+                  << grids[level].size() << " (" << ncells / nprocs << " cells per rank)" << '\n';
+
+    return true;
+}
+
 void
 Gravity::set_mass_offset (Real time)
 {
@@ -1793,16 +2333,38 @@ Gravity::set_mass_offset (Real time)
     }
 }
 
+//
+// The multipole expansion is about the center of the domain, with distances
+// in units of half the domain diagonal.
+//
+static
+void
+multipole_center_and_scale (const Geometry& geom,
+                            Real*           center,
+                            Real&           rscale)
+{
+    Real diag2 = 0;
+    for (int i = 0; i < BL_SPACEDIM; i++)
+    {
+        center[i] = 0.5 * (geom.ProbLo(i) + geom.ProbHi(i));
+        diag2    += geom.ProbLength(i) * geom.ProbLength(i);
+    }
+    rscale = 0.5 * std::sqrt(diag2);
+}
+
 void
 Gravity::set_dirichlet_bcs (int       level,
                             MultiFab* phi)
 {
     const Real* dx        = parent->Geom(level).CellSize();
+    const Real* problo    = parent->Geom(level).ProbLo();
     const int*  domain_lo = parent->Geom(level).Domain().loVect();
     const int*  domain_hi = parent->Geom(level).Domain().hiVect();
 
     // Set phi to zero on all the ghost cells outside the domain.
-    // If homogeneous bc's then we stop here; if not we add monopole bc's from each particle
+    // If homogeneous bc's then we stop here; if not we add monopole bc's from
+    // each particle, or evaluate the multipole expansion there when asked to
+    // and it converges
     for (MFIter mfi(*phi); mfi.isValid(); ++mfi)
     {
         const Box& box = mfi.validbox();
@@ -1813,7 +2375,27 @@ Gravity::set_dirichlet_bcs (int       level,
             (lo, hi, domain_lo, domain_hi, BL_TO_FORTRAN((*phi)[mfi]), dx);
     }
 
-    if (monopole_bcs && Nyx::theDMPC())
+    if (monopole_bcs && max_multipole_order >= 0 && multipole_valid)
+    {
+        BL_ASSERT(multipole_moments.size() == 2*(max_multipole_order+1)*(max_multipole_order+1));
+
+        const int nmom = (max_multipole_order+1)*(max_multipole_order+1);
+        Real center[BL_SPACEDIM], rscale;
+        multipole_center_and_scale(parent->Geom(0), center, rscale);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(*phi); mfi.isValid(); ++mfi)
+        {
+            const Box& box = mfi.validbox(); const int* lo  = box.loVect(); const int* hi  = box.hiVect();
+            BL_FORT_PROC_CALL(FORT_ADD_MULTIPOLE_BCS, fort_add_multipole_bcs)
+                (lo, hi, domain_lo, domain_hi, &max_multipole_order,
+                 multipole_moments.dataPtr(), multipole_moments.dataPtr() + nmom,
+                 center, &rscale, BL_TO_FORTRAN((*phi)[mfi]), dx, problo);
+        }
+    }
+    else if (monopole_bcs && Nyx::theDMPC())
     {
         Array<Real> part_locs;
         Nyx::theDMPC()->GetParticleLocations(part_locs);
@@ -1836,6 +2418,126 @@ Gravity::set_dirichlet_bcs (int       level,
     }
 }
 
+//
+// The moments are taken about the center of the domain, of the level 0 gas
+// density (which the finer levels have been averaged onto) and of the active
+// particles at every level.  Each rank only visits its own grids and
+// particles, and a single reduction of 2 (lmax+1)^2 numbers combines them.
+// Like the Poisson rhs the mass is divided by a.
+//
+void
+Gravity::compute_multipole_moments (Real time)
+{
+    BL_PROFILE("Gravity::compute_multipole_moments()");
+
+    const Real strt = ParallelDescriptor::second();
+
+    const Geometry& geom   = parent->Geom(0);
+    const Real*     dx     = geom.CellSize();
+    const Real*     problo = geom.ProbLo();
+    const int       lmax   = max_multipole_order;
+    const int       nmom   = (lmax+1)*(lmax+1);
+
+    Real center[BL_SPACEDIM], rscale;
+    multipole_center_and_scale(geom, center, rscale);
+
+    multipole_moments.resize(2*nmom);
+    for (int n = 0; n < 2*nmom; n++)
+        multipole_moments[n] = 0;
+
+    // The largest distance of any mass from the center
+    Real rmax = 0;
+
+#ifndef NO_HYDRO
+    if (Nyx::Do_Hydro() == 1)
+    {
+        const StateData& sd = LevelData[0]->get_state_data(State_Type);
+        const MultiFab& S = (std::abs(time - sd.prevTime()) < std::abs(time - sd.curTime()))
+                          ? LevelData[0]->get_old_data(State_Type)
+                          : LevelData[0]->get_new_data(State_Type);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+          Array<Real> moments_loc(2*nmom,0);
+          Real        rmax_loc = 0;
+
+          for (MFIter mfi(S,true); mfi.isValid(); ++mfi)
+          {
+            const Box& bx = mfi.tilebox();
+
+            BL_FORT_PROC_CALL(FORT_ADD_GRID_MULTIPOLE_MOMENTS, fort_add_grid_multipole_moments)
+                (bx.loVect(), bx.hiVect(),
+                 BL_TO_FORTRAN_N(S[mfi],density),
+                 dx, problo, center, &rscale, &lmax,
+                 moments_loc.dataPtr(), moments_loc.dataPtr() + nmom, &rmax_loc);
+          }
+
+#ifdef _OPENMP
+#pragma omp critical (multipole_moments)
+#endif
+          {
+              for (int n = 0; n < 2*nmom; n++)
+                  multipole_moments[n] += moments_loc[n];
+              rmax = std::max(rmax, rmax_loc);
+          }
+        }
+    }
+#endif
+
+    Array<Real> part_locs, part_mass;
+    for (int i = 0; i < Nyx::theActiveParticles().size(); i++)
+    {
+        for (int lev = 0; lev <= Nyx::theActiveParticles()[i]->finestLevel(); lev++)
+        {
+            Nyx::theActiveParticles()[i]->GetLocalParticleLocationsAndMass(lev, part_locs, part_mass);
+
+            const int npart = part_mass.size();
+            if (npart > 0)
+                BL_FORT_PROC_CALL(FORT_ADD_PARTICLE_MULTIPOLE_MOMENTS, fort_add_particle_multipole_moments)
+                    (&npart, part_locs.dataPtr(), part_mass.dataPtr(),
+                     center, &rscale, &lmax,
+                     multipole_moments.dataPtr(), multipole_moments.dataPtr() + nmom, &rmax);
+        }
+    }
+
+    ParallelDescriptor::ReduceRealSum(multipole_moments.dataPtr(), 2*nmom);
+    ParallelDescriptor::ReduceRealMax(rmax);
+
+    //
+    // phi is evaluated on the domain faces, the nearest of which is half the
+    // shortest side from the center.  If any mass is at least that far out the
+    // expansion diverges there, and set_dirichlet_bcs sums over the particles.
+    //
+    Real rface = 0.5 * geom.ProbLength(0);
+    for (int i = 1; i < BL_SPACEDIM; i++)
+        rface = std::min(rface, 0.5 * geom.ProbLength(i));
+
+    multipole_valid = rmax < rface;
+
+    if (!multipole_valid && verbose && ParallelDescriptor::IOProcessor())
+        std::cout << "Gravity::compute_multipole_moments(): mass out to r = " << rmax
+                  << " reaches the domain faces at " << rface
+                  << ", using the direct sum over the particles instead" << '\n';
+
+    Nyx* cs = dynamic_cast<Nyx*>(&parent->getLevel(0));
+    BL_ASSERT(cs != 0);
+    const Real a_inverse = 1. / cs->get_comoving_a(time);
+    for (int n = 0; n < 2*nmom; n++)
+        multipole_moments[n] *= a_inverse;
+
+    if (show_timings)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real end = ParallelDescriptor::second() - strt;
+
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Gravity::compute_multipole_moments() time = " << end << '\n';
+    }
+}
+
 #ifdef CGRAV
 void
 Gravity::make_prescribed_grav (int       level,
@@ -1889,7 +2591,18 @@ Gravity::AddParticlesToRhs (int               level,
     for (int i = 0; i < Nyx::theActiveParticles().size(); i++)
     {
         particle_mf.setVal(0.);
+#ifdef NEUTRINO_PARTICLES
+        if (Nyx::theActiveParticles()[i] == Nyx::theNPC() &&
+            (neutrino_deposit_ratio > 1 || neutrino_deposit_interval > 1))
+        {
+            neutrino_density(level, particle_mf);
+            MultiFab::Add(Rhs, particle_mf, 0, 0, 1, 0);
+            continue;
+        }
+#endif
         Nyx::theActiveParticles()[i]->AssignDensitySingleLevel(particle_mf, level);
+        if (Nyx::theActiveParticles()[i] == Nyx::theDMPC())
+            smooth_for_short_range(level, particle_mf);
         MultiFab::Add(Rhs, particle_mf, 0, 0, 1, 0);
     }
 }
@@ -1900,6 +2613,20 @@ Gravity::AddParticlesToRhs(int base_level, int finest_level, const Array<MultiFa
     const int num_levels = finest_level - base_level + 1;
     for (int i = 0; i < Nyx::theActiveParticles().size(); i++)
     {
+#ifdef NEUTRINO_PARTICLES
+        //
+        // Only without finer levels, whose neutrinos the coarse deposit of
+        // a level would not see.
+        //
+        if (num_levels == 1 && Nyx::theActiveParticles()[i] == Nyx::theNPC() &&
+            (neutrino_deposit_ratio > 1 || neutrino_deposit_interval > 1))
+        {
+            MultiFab nu_mf(grids[base_level], dmap[base_level], 1, 0);
+            neutrino_density(base_level, nu_mf);
+            MultiFab::Add(*Rhs_particles[0], nu_mf, 0, 0, 1, 0);
+            continue;
+        }
+#endif
         Array<std::unique_ptr<MultiFab> > PartMF;
         Nyx::theActiveParticles()[i]->AssignDensity(PartMF, base_level, 1, finest_level);
         for (int lev = 0; lev < num_levels; lev++)
@@ -1917,6 +2644,9 @@ Gravity::AddParticlesToRhs(int base_level, int finest_level, const Array<MultiFa
                                  0, 1, parent->refRatio(lev+base_level));
         }
 
+        if (num_levels == 1 && Nyx::theActiveParticles()[i] == Nyx::theDMPC())
+            smooth_for_short_range(base_level, *PartMF[0]);
+
         for (int lev = 0; lev < num_levels; lev++)
         {
             MultiFab::Add(*Rhs_particles[lev], *PartMF[lev], 0, 0, 1, 0);
@@ -1925,6 +2655,192 @@ Gravity::AddParticlesToRhs(int base_level, int finest_level, const Array<MultiFa
 
 }
 
+//
+// Convolve mf with a Gaussian of sigma cells, as three 1-d passes of a
+// kernel truncated at three standard deviations and normalized so that
+// the mass is unchanged.
+//
+static void
+gaussian_smooth (MultiFab&       mf,
+                 const Geometry& geom,
+                 Real            sigma)
+{
+    const int nw = static_cast<int>(std::ceil(3.0 * sigma));
+
+    Array<Real> w(2*nw+1);
+    Real wsum = 0;
+    for (int m = -nw; m <= nw; m++)
+    {
+        w[m+nw] = std::exp(-0.5 * m * m / (sigma * sigma));
+        wsum   += w[m+nw];
+    }
+    for (int m = 0; m < w.size(); m++)
+        w[m] /= wsum;
+
+    // Zero outside a non-periodic domain, where there is no mass
+    MultiFab tmp(mf.boxArray(), mf.DistributionMap(), 1, nw);
+    tmp.setVal(0.0);
+
+    for (int dir = 0; dir < BL_SPACEDIM; dir++)
+    {
+        MultiFab::Copy(tmp, mf, 0, 0, 1, 0);
+        tmp.FillBoundary(geom.periodicity());
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (MFIter mfi(mf,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            FORT_SMOOTH_DIR(bx.loVect(), bx.hiVect(),
+                            BL_TO_FORTRAN(tmp[mfi]),
+                            BL_TO_FORTRAN(mf[mfi]),
+                            &dir, w.dataPtr(), &nw);
+        }
+    }
+}
+
+//
+// The mesh force on scale rs is that of the density convolved with
+// exp(-r^2/(4 rs^2)), which leaves erfc(r/2rs) + r/(rs sqrt(pi)) exp(-r^2/4rs^2)
+// of the point-mass force to short_range_kick.
+//
+void
+Gravity::smooth_for_short_range (int       level,
+                                 MultiFab& mf)
+{
+    if (short_range_rs <= 0 || level > 0)
+        return;
+
+    BL_PROFILE("Gravity::smooth_for_short_range()");
+
+    gaussian_smooth(mf, parent->Geom(level), std::sqrt(2.0) * short_range_rs);
+}
+
+#ifdef NEUTRINO_PARTICLES
+//
+// The neutrinos sample a nearly smooth distribution, so depositing them on
+// coarser cells and smoothing there costs less than the full deposit and
+// keeps most of their shot noise out of the rhs.
+//
+void
+Gravity::neutrino_density (int       level,
+                           MultiFab& mf)
+{
+    BL_PROFILE("Gravity::neutrino_density()");
+
+    if (neutrino_density_saved.size() <= level)
+    {
+        neutrino_density_saved.resize(level+1);
+        neutrino_density_step.resize(level+1, -1);
+    }
+
+    std::unique_ptr<MultiFab>& saved = neutrino_density_saved[level];
+    const int                  step  = parent->levelSteps(level);
+
+    if (saved && saved->boxArray() == grids[level] && saved->DistributionMap() == dmap[level] &&
+        step >= neutrino_density_step[level] &&
+        step <  neutrino_density_step[level] + neutrino_deposit_interval)
+    {
+        mf.copy(*saved, 0, 0, 1);
+        return;
+    }
+
+    const Real strt = ParallelDescriptor::second();
+
+    NeutrinoParticleContainer* npc   = Nyx::theNPC();
+    const int                  ratio = neutrino_deposit_ratio;
+    const Geometry&            geom  = parent->Geom(level);
+    const BoxArray&            pba   = npc->ParticleBoxArray(level);
+
+    if (!pba.coarsenable(ratio))
+        amrex::Error("gravity.neutrino_deposit_ratio must divide the particle grids");
+
+    int is_per[BL_SPACEDIM];
+    for (int d = 0; d < BL_SPACEDIM; d++)
+        is_per[d] = geom.isPeriodic(d);
+
+    const Geometry cgeom(amrex::coarsen(geom.Domain(), ratio), &geom.ProbDomain(),
+                         geom.Coord(), is_per);
+
+    MultiFab crse(amrex::coarsen(pba, ratio), npc->ParticleDistributionMap(level), 1, 1);
+    npc->AssignRelativisticDensityCoarse(crse, cgeom, level);
+
+    // At the full resolution the deposit is left as it is
+    if (ratio > 1 && neutrino_smooth_sigma > 0)
+        gaussian_smooth(crse, cgeom, neutrino_smooth_sigma);
+
+    // Zero outside a non-periodic domain, where there is no mass
+    crse.setBndry(0.0);
+    crse.FillBoundary(cgeom.periodicity());
+
+    MultiFab fine(pba, npc->ParticleDistributionMap(level), 1, 0);
+    const int add = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(fine,true); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.tilebox();
+        FORT_INTERP_CC(bx.loVect(), bx.hiVect(),
+                       BL_TO_FORTRAN(fine[mfi]),
+                       BL_TO_FORTRAN(crse[mfi]),
+                       &ratio, &add);
+    }
+
+    mf.copy(fine, 0, 0, 1);
+
+    if (neutrino_deposit_interval > 1)
+    {
+        saved.reset(new MultiFab(grids[level], dmap[level], 1, 0));
+        saved->copy(fine, 0, 0, 1);
+        neutrino_density_step[level] = step;
+    }
+
+    if (show_timings)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real end = ParallelDescriptor::second() - strt;
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Gravity::neutrino_density() time = " << end << '\n';
+    }
+}
+#endif
+
+void
+Gravity::short_range_kick (int  level,
+                           Real dt,
+                           Real a)
+{
+    if (short_range_rs <= 0 || level > 0 || Nyx::theDMPC() == 0)
+        return;
+
+    BL_PROFILE("Gravity::short_range_kick()");
+
+    const Real strt = ParallelDescriptor::second();
+
+    // Ggravity is -4 pi G, and the force carries the same 1/a as the mesh
+    // force; the second 1/a turns the change of a*v into one of v
+    const Real  G    = -Ggravity / (4.0 * M_PI);
+    const Real* dx   = parent->Geom(level).CellSize();
+    const Real  rs   = short_range_rs * dx[0];
+    const Real  rcut = short_range_rcut * rs;
+    const Real  eps  = short_range_eps * dx[0];
+
+    Nyx::theDMPC()->ShortRangeKick(level, dt * G / (a * a), rs, rcut, eps);
+
+    if (show_timings)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real end = ParallelDescriptor::second() - strt;
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Gravity::short_range_kick() time = " << end << '\n';
+    }
+}
+
 void
 Gravity::AddVirtualParticlesToRhs (int               level,
                                    MultiFab&         Rhs,
@@ -2065,6 +2981,39 @@ Gravity::solve_with_Cpp(int level, MultiFab& soln, const Array<MultiFab*>& grad_
   grad_phi[2]->mult(-1.0);
 }
 
+Real
+Gravity::solve_with_GMG (int                     level,
+                         MultiFab&               soln,
+                         const Array<MultiFab*>& grad_phi,
+                         MultiFab&               rhs,
+                         Real                    tol,
+                         Real                    abs_tol)
+{
+    BL_PROFILE("Gravity::solve_with_GMG()");
+
+    // The Dirichlet sides take their values from the ghost cells of soln
+    int bc[2*BL_SPACEDIM];
+    for (int n = 0; n < 2*BL_SPACEDIM; ++n)
+    {
+        if (mg_bc[n] == 0)
+            bc[n] = GeometricMG::Periodic;
+        else if (mg_bc[n] == MGT_BC_DIR)
+            bc[n] = GeometricMG::Dirichlet;
+        else
+            bc[n] = GeometricMG::Neumann;
+    }
+
+    GeometricMG gmg(parent->Geom(level), grids[level], dmap[level], bc,
+                    gmg_order, gmg_cheby_degree, verbose, agglomerate_cells_per_rank,
+                    gmg_single_precision);
+
+    const Real final_resnorm = gmg.solve(soln, rhs, tol, abs_tol, gmg_max_iter, gmg_use_fmg);
+
+    gmg.get_grad_phi(soln, grad_phi);
+
+    return final_resnorm;
+}
+
 #ifdef USEHPGMG
 void
 Gravity::solve_with_HPGMG(int level,
@@ -2215,8 +3164,21 @@ Gravity::AddProcsToComp(Amr *aptr, int level, AmrLevel *level_data_to_install,
      allInts.push_back(no_composite);
      allInts.push_back(dirichlet_bcs);
      allInts.push_back(monopole_bcs);
+     allInts.push_back(max_multipole_order);
+     allInts.push_back(phi_guess_order);
+     allInts.push_back(phi_guess_in_a);
+     allInts.push_back(adaptive_tol);
+     allInts.push_back(agglomerate_cells_per_rank);
+     allInts.push_back(reuse_old_phi);
+     allInts.push_back(phi_new_current);
      allInts.push_back(solve_with_cpp);
      allInts.push_back(solve_with_hpgmg);
+     allInts.push_back(solve_with_gmg);
+     allInts.push_back(gmg_order);
+     allInts.push_back(gmg_cheby_degree);
+     allInts.push_back(gmg_max_iter);
+     allInts.push_back(gmg_use_fmg);
+     allInts.push_back(gmg_single_precision);
      allInts.push_back(stencil_type);
      for(int i(0); i < 2*BL_SPACEDIM; ++i)    { allInts.push_back(mg_bc[i]); }
    }
@@ -2236,8 +3198,21 @@ Gravity::AddProcsToComp(Amr *aptr, int level, AmrLevel *level_data_to_install,
      no_composite = allInts[count++];
      dirichlet_bcs = allInts[count++];
      monopole_bcs = allInts[count++];
+     max_multipole_order = allInts[count++];
+     phi_guess_order = allInts[count++];
+     phi_guess_in_a = allInts[count++];
+     adaptive_tol = allInts[count++];
+     agglomerate_cells_per_rank = allInts[count++];
+     reuse_old_phi = allInts[count++];
+     phi_new_current = allInts[count++];
      solve_with_cpp = allInts[count++];
      solve_with_hpgmg = allInts[count++];
+     solve_with_gmg = allInts[count++];
+     gmg_order = allInts[count++];
+     gmg_cheby_degree = allInts[count++];
+     gmg_max_iter = allInts[count++];
+     gmg_use_fmg = allInts[count++];
+     gmg_single_precision = allInts[count++];
      stencil_type = allInts[count++];
      for(int i(0); i < 2*BL_SPACEDIM; ++i)    { mg_bc[i] = allInts[count++]; }
 
@@ -2252,11 +3227,20 @@ Gravity::AddProcsToComp(Amr *aptr, int level, AmrLevel *level_data_to_install,
      allReals.push_back(sl_tol);
      allReals.push_back(ml_tol);
      allReals.push_back(delta_tol);
+     allReals.push_back(adaptive_tol_fraction);
+     allReals.push_back(adaptive_tol_max);
+     allReals.push_back(short_range_rs);
+     allReals.push_back(short_range_rcut);
+     allReals.push_back(short_range_eps);
+     allReals.push_back(sync_skip_fraction);
+     allReals.push_back(sync_max_tol);
      allReals.push_back(Ggravity);
    }
 
    amrex::BroadcastArray(allReals, scsMyId, ioProcNumSCS, scsComm);
    amrex::BroadcastArray(level_solver_resnorm, scsMyId, ioProcNumSCS, scsComm);
+   amrex::BroadcastArray(level_rhs_norm, scsMyId, ioProcNumSCS, scsComm);
+   amrex::BroadcastArray(sync_skipped_norm, scsMyId, ioProcNumSCS, scsComm);
 
    // ---- unpack the Reals
    if(scsMyId != ioProcNumSCS) {
@@ -2265,6 +3249,13 @@ Gravity::AddProcsToComp(Amr *aptr, int level, AmrLevel *level_data_to_install,
      sl_tol = allReals[count++];
      ml_tol = allReals[count++];
      delta_tol = allReals[count++];
+     adaptive_tol_fraction = allReals[count++];
+     adaptive_tol_max = allReals[count++];
+     short_range_rs = allReals[count++];
+     short_range_rcut = allReals[count++];
+     short_range_eps = allReals[count++];
+     sync_skip_fraction = allReals[count++];
+     sync_max_tol = allReals[count++];
      Ggravity = allReals[count++];
 
      BL_ASSERT(count == allReals.size());
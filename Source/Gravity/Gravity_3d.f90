@@ -236,3 +236,134 @@
 
       end subroutine fort_pc_edge_interp
 
+
+! :: ----------------------------------------------------------
+! :: Largest 7-point second difference of rhs over lo:hi.  For a
+! :: second-order Laplacian the truncation error in phi is about
+! :: 1/12 of this relative to rhs, and CIC shot noise shows up here
+! :: as well.  Only neighbors inside lo-1:hi+1 are used.
+! :: ----------------------------------------------------------
+
+      subroutine fort_rhs_second_diff_max(lo, hi, &
+                                          rhs, r_l1, r_l2, r_l3, r_h1, r_h2, r_h3, &
+                                          diff_max)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3)
+      integer , intent(in   ) :: r_l1, r_l2, r_l3, r_h1, r_h2, r_h3
+      real(rt), intent(in   ) :: rhs(r_l1:r_h1,r_l2:r_h2,r_l3:r_h3)
+      real(rt), intent(inout) :: diff_max
+
+      integer i, j, k
+
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+               diff_max = max(diff_max, abs(rhs(i+1,j,k) + rhs(i-1,j,k) &
+                                          + rhs(i,j+1,k) + rhs(i,j-1,k) &
+                                          + rhs(i,j,k+1) + rhs(i,j,k-1) &
+                                          - 6.d0 * rhs(i,j,k)))
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_rhs_second_diff_max
+
+! ::: -----------------------------------------------------------
+! ::: Convolve src with the 2*nw+1 point kernel w along direction
+! ::: dir (0, 1 or 2) into dst on lo:hi.  src needs nw ghost cells
+! ::: in that direction.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_smooth_dir(lo, hi, &
+                                 src, s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
+                                 dst, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                 dir, w, nw)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), dir, nw
+      integer , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+      integer , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+      real(rt), intent(in   ) :: src(s_l1:s_h1,s_l2:s_h2,s_l3:s_h3)
+      real(rt), intent(inout) :: dst(d_l1:d_h1,d_l2:d_h2,d_l3:d_h3)
+      real(rt), intent(in   ) :: w(-nw:nw)
+
+      integer i, j, k, m, ii, jj, kk
+      real(rt) sum
+
+      ii = 0
+      jj = 0
+      kk = 0
+      if (dir .eq. 0) ii = 1
+      if (dir .eq. 1) jj = 1
+      if (dir .eq. 2) kk = 1
+
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+               sum = 0.d0
+               do m = -nw, nw
+                  sum = sum + w(m) * src(i+m*ii,j+m*jj,k+m*kk)
+               enddo
+               dst(i,j,k) = sum
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_smooth_dir
+
+! ::: -----------------------------------------------------------
+! ::: Trilinear cell-centered interpolation of crse, refined by
+! ::: ratio, onto the fine lo:hi, added to fine if add = 1 and
+! ::: replacing it otherwise.  crse needs one filled ghost cell.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_interp_cc(lo, hi, &
+                                fine, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                crse, c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                ratio, add)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), ratio, add
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      integer , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+      real(rt), intent(inout) :: fine(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(rt), intent(in   ) :: crse(c_l1:c_h1,c_l2:c_h2,c_l3:c_h3)
+
+      integer i, j, k, ic, jc, kc
+      real(rt) x, y, z, wx, wy, wz, val
+
+      do k = lo(3), hi(3)
+         z  = (k + 0.5d0) / ratio - 0.5d0
+         kc = floor(z)
+         wz = z - kc
+         do j = lo(2), hi(2)
+            y  = (j + 0.5d0) / ratio - 0.5d0
+            jc = floor(y)
+            wy = y - jc
+            do i = lo(1), hi(1)
+               x  = (i + 0.5d0) / ratio - 0.5d0
+               ic = floor(x)
+               wx = x - ic
+
+               val = (1.d0-wz) * ( (1.d0-wy) * ((1.d0-wx) * crse(ic,jc  ,kc  ) + wx * crse(ic+1,jc  ,kc  )) &
+                                 +       wy  * ((1.d0-wx) * crse(ic,jc+1,kc  ) + wx * crse(ic+1,jc+1,kc  )) ) &
+                   +       wz  * ( (1.d0-wy) * ((1.d0-wx) * crse(ic,jc  ,kc+1) + wx * crse(ic+1,jc  ,kc+1)) &
+                                 +       wy  * ((1.d0-wx) * crse(ic,jc+1,kc+1) + wx * crse(ic+1,jc+1,kc+1)) )
+
+               if (add .eq. 1) then
+                  fine(i,j,k) = fine(i,j,k) + val
+               else
+                  fine(i,j,k) = val
+               endif
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_interp_cc
@@ -0,0 +1,403 @@
+! ::: -----------------------------------------------------------
+! ::: Kernels of the native geometric multigrid (GeometricMG) for
+! ::: A phi = rhs with A = -Lap.  With order = 2, A is the standard
+! ::: seven-point operator; with order = 4 it is the nineteen-point
+! ::: Mehrstellen operator, which needs cubic cells.
+! ::: -----------------------------------------------------------
+
+! ::: -----------------------------------------------------------
+! ::: res = rhs - A phi on lo:hi.  phi must have its ghost cells
+! ::: filled (edges too for order = 4).
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_residual(lo, hi, &
+                                   res, r_l1, r_l2, r_l3, r_h1, r_h2, r_h3, &
+                                   phi, p_l1, p_l2, p_l3, p_h1, p_h2, p_h3, &
+                                   rhs, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                   dx, order)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), order
+      integer , intent(in   ) :: r_l1, r_l2, r_l3, r_h1, r_h2, r_h3
+      integer , intent(in   ) :: p_l1, p_l2, p_l3, p_h1, p_h2, p_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(rt), intent(inout) :: res(r_l1:r_h1,r_l2:r_h2,r_l3:r_h3)
+      real(rt), intent(in   ) :: phi(p_l1:p_h1,p_l2:p_h2,p_l3:p_h3)
+      real(rt), intent(in   ) :: rhs(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(rt), intent(in   ) :: dx(3)
+
+      integer i, j, k
+      real(rt) ax, ay, az, c6
+
+      if (order .eq. 4) then
+
+         c6 = 1.d0 / (6.d0 * dx(1)**2)
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  res(i,j,k) = rhs(i,j,k) + c6 * ( &
+                       2.d0 * ( phi(i-1,j,k) + phi(i+1,j,k) &
+                              + phi(i,j-1,k) + phi(i,j+1,k) &
+                              + phi(i,j,k-1) + phi(i,j,k+1) ) &
+                       + phi(i-1,j-1,k) + phi(i+1,j-1,k) + phi(i-1,j+1,k) + phi(i+1,j+1,k) &
+                       + phi(i-1,j,k-1) + phi(i+1,j,k-1) + phi(i-1,j,k+1) + phi(i+1,j,k+1) &
+                       + phi(i,j-1,k-1) + phi(i,j+1,k-1) + phi(i,j-1,k+1) + phi(i,j+1,k+1) &
+                       - 24.d0 * phi(i,j,k) )
+               enddo
+            enddo
+         enddo
+
+      else
+
+         ax = 1.d0 / dx(1)**2
+         ay = 1.d0 / dx(2)**2
+         az = 1.d0 / dx(3)**2
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  res(i,j,k) = rhs(i,j,k) &
+                       + ax * (phi(i-1,j,k) - 2.d0*phi(i,j,k) + phi(i+1,j,k)) &
+                       + ay * (phi(i,j-1,k) - 2.d0*phi(i,j,k) + phi(i,j+1,k)) &
+                       + az * (phi(i,j,k-1) - 2.d0*phi(i,j,k) + phi(i,j,k+1))
+               enddo
+            enddo
+         enddo
+
+      endif
+
+      end subroutine fort_gmg_residual
+
+! ::: -----------------------------------------------------------
+! ::: One Chebyshev step with Jacobi preconditioning:
+! :::   xnew = x + c1 (x - xold) + c2 D^-1 (rhs - A x)
+! ::: x must have its ghost cells filled.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_cheby(lo, hi, &
+                                xnew, n_l1, n_l2, n_l3, n_h1, n_h2, n_h3, &
+                                x   , x_l1, x_l2, x_l3, x_h1, x_h2, x_h3, &
+                                xold, o_l1, o_l2, o_l3, o_h1, o_h2, o_h3, &
+                                rhs , f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                dx, order, c1, c2)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), order
+      integer , intent(in   ) :: n_l1, n_l2, n_l3, n_h1, n_h2, n_h3
+      integer , intent(in   ) :: x_l1, x_l2, x_l3, x_h1, x_h2, x_h3
+      integer , intent(in   ) :: o_l1, o_l2, o_l3, o_h1, o_h2, o_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(rt), intent(inout) :: xnew(n_l1:n_h1,n_l2:n_h2,n_l3:n_h3)
+      real(rt), intent(in   ) :: x   (x_l1:x_h1,x_l2:x_h2,x_l3:x_h3)
+      real(rt), intent(in   ) :: xold(o_l1:o_h1,o_l2:o_h2,o_l3:o_h3)
+      real(rt), intent(in   ) :: rhs (f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(rt), intent(in   ) :: dx(3), c1, c2
+
+      integer i, j, k
+      real(rt) ax, ay, az, c6, dinv, r
+
+      if (order .eq. 4) then
+
+         c6   = 1.d0 / (6.d0 * dx(1)**2)
+         dinv = 1.d0 / (24.d0 * c6)
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  r = rhs(i,j,k) + c6 * ( &
+                       2.d0 * ( x(i-1,j,k) + x(i+1,j,k) &
+                              + x(i,j-1,k) + x(i,j+1,k) &
+                              + x(i,j,k-1) + x(i,j,k+1) ) &
+                       + x(i-1,j-1,k) + x(i+1,j-1,k) + x(i-1,j+1,k) + x(i+1,j+1,k) &
+                       + x(i-1,j,k-1) + x(i+1,j,k-1) + x(i-1,j,k+1) + x(i+1,j,k+1) &
+                       + x(i,j-1,k-1) + x(i,j+1,k-1) + x(i,j-1,k+1) + x(i,j+1,k+1) &
+                       - 24.d0 * x(i,j,k) )
+                  xnew(i,j,k) = x(i,j,k) + c1 * (x(i,j,k) - xold(i,j,k)) + c2 * dinv * r
+               enddo
+            enddo
+         enddo
+
+      else
+
+         ax   = 1.d0 / dx(1)**2
+         ay   = 1.d0 / dx(2)**2
+         az   = 1.d0 / dx(3)**2
+         dinv = 1.d0 / (2.d0 * (ax + ay + az))
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  r = rhs(i,j,k) &
+                       + ax * (x(i-1,j,k) - 2.d0*x(i,j,k) + x(i+1,j,k)) &
+                       + ay * (x(i,j-1,k) - 2.d0*x(i,j,k) + x(i,j+1,k)) &
+                       + az * (x(i,j,k-1) - 2.d0*x(i,j,k) + x(i,j,k+1))
+                  xnew(i,j,k) = x(i,j,k) + c1 * (x(i,j,k) - xold(i,j,k)) + c2 * dinv * r
+               enddo
+            enddo
+         enddo
+
+      endif
+
+      end subroutine fort_gmg_cheby
+
+! ::: -----------------------------------------------------------
+! ::: crse = average of the eight fine cells, on the coarse lo:hi.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_restrict(lo, hi, &
+                                   crse, c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                   fine, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3)
+      integer , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(rt), intent(inout) :: crse(c_l1:c_h1,c_l2:c_h2,c_l3:c_h3)
+      real(rt), intent(in   ) :: fine(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+
+      integer i, j, k, ii, jj, kk
+
+      do k = lo(3), hi(3)
+         kk = 2*k
+         do j = lo(2), hi(2)
+            jj = 2*j
+            do i = lo(1), hi(1)
+               ii = 2*i
+               crse(i,j,k) = 0.125d0 * ( &
+                    fine(ii,jj  ,kk  ) + fine(ii+1,jj  ,kk  ) + &
+                    fine(ii,jj+1,kk  ) + fine(ii+1,jj+1,kk  ) + &
+                    fine(ii,jj  ,kk+1) + fine(ii+1,jj  ,kk+1) + &
+                    fine(ii,jj+1,kk+1) + fine(ii+1,jj+1,kk+1) )
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_restrict
+
+! ::: -----------------------------------------------------------
+! ::: Trilinear cell-centered interpolation of crse onto the fine
+! ::: lo:hi, added to fine if add = 1 and replacing it otherwise.
+! ::: crse must have its ghost cells filled.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_interp(lo, hi, &
+                                 fine, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                 crse, c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                 add)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), add
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      integer , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+      real(rt), intent(inout) :: fine(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(rt), intent(in   ) :: crse(c_l1:c_h1,c_l2:c_h2,c_l3:c_h3)
+
+      integer i, j, k, ic, jc, kc, io, jo, ko
+      real(rt) val
+
+      do k = lo(3), hi(3)
+         kc = k / 2
+         ko = 2*(k - 2*kc) - 1
+         do j = lo(2), hi(2)
+            jc = j / 2
+            jo = 2*(j - 2*jc) - 1
+            do i = lo(1), hi(1)
+               ic = i / 2
+               io = 2*(i - 2*ic) - 1
+
+               ! (io,jo,ko) points from the parent towards the nearer neighbours
+               val = ( 27.d0 *  crse(ic   ,jc   ,kc   ) &
+                     +  9.d0 * (crse(ic+io,jc   ,kc   ) &
+                              + crse(ic   ,jc+jo,kc   ) &
+                              + crse(ic   ,jc   ,kc+ko)) &
+                     +  3.d0 * (crse(ic+io,jc+jo,kc   ) &
+                              + crse(ic+io,jc   ,kc+ko) &
+                              + crse(ic   ,jc+jo,kc+ko)) &
+                     +          crse(ic+io,jc+jo,kc+ko) ) / 64.d0
+
+               if (add .eq. 1) then
+                  fine(i,j,k) = fine(i,j,k) + val
+               else
+                  fine(i,j,k) = val
+               endif
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_interp
+
+! ::: -----------------------------------------------------------
+! ::: Fill the ghost cells of phi just outside the faces of lo:hi
+! ::: that lie on a non-periodic side of the domain.  bc holds the
+! ::: type of each side (lo x, hi x, lo y, ...): 1 for Dirichlet,
+! ::: where the ghost value puts bndry (or 0 if homog = 1) on the
+! ::: face, and 2 for Neumann with zero normal gradient.  The
+! ::: planes of each direction extend over the ghost cells of the
+! ::: directions before it, so that the edge and corner ghost cells
+! ::: get filled as well.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_fill_bc(lo, hi, domlo, domhi, &
+                                  phi, p_l1, p_l2, p_l3, p_h1, p_h2, p_h3, &
+                                  bndry, b_l1, b_l2, b_l3, b_h1, b_h2, b_h3, &
+                                  bc, homog)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), domlo(3), domhi(3), bc(6), homog
+      integer , intent(in   ) :: p_l1, p_l2, p_l3, p_h1, p_h2, p_h3
+      integer , intent(in   ) :: b_l1, b_l2, b_l3, b_h1, b_h2, b_h3
+      real(rt), intent(inout) :: phi  (p_l1:p_h1,p_l2:p_h2,p_l3:p_h3)
+      real(rt), intent(in   ) :: bndry(b_l1:b_h1,b_l2:b_h2,b_l3:b_h3)
+
+      integer dir, side, ig, jg, kg, ii, jj, kk
+      integer glo(3), ghi(3), n(3)
+      real(rt) b
+
+      do dir = 1, 3
+         do side = 0, 1
+
+            if (bc(2*dir-1+side) .eq. 0) cycle
+
+            if (side .eq. 0) then
+               if (lo(dir) .ne. domlo(dir)) cycle
+            else
+               if (hi(dir) .ne. domhi(dir)) cycle
+            endif
+
+            ! The ghost plane and the unit normal pointing into the box
+            glo = lo
+            ghi = hi
+            n   = 0
+            glo(1:dir-1) = lo(1:dir-1) - 1
+            ghi(1:dir-1) = hi(1:dir-1) + 1
+            if (side .eq. 0) then
+               glo(dir) = lo(dir) - 1
+               ghi(dir) = lo(dir) - 1
+               n(dir)   = 1
+            else
+               glo(dir) = hi(dir) + 1
+               ghi(dir) = hi(dir) + 1
+               n(dir)   = -1
+            endif
+
+            do kg = glo(3), ghi(3)
+               kk = kg + n(3)
+               do jg = glo(2), ghi(2)
+                  jj = jg + n(2)
+                  do ig = glo(1), ghi(1)
+                     ii = ig + n(1)
+                     if (bc(2*dir-1+side) .eq. 1) then
+                        b = 0.d0
+                        if (homog .eq. 0) b = bndry(ig,jg,kg)
+                        phi(ig,jg,kg) = 2.d0 * b - phi(ii,jj,kk)
+                     else
+                        phi(ig,jg,kg) = phi(ii,jj,kk)
+                     endif
+                  enddo
+               enddo
+            enddo
+
+         enddo
+      enddo
+
+      end subroutine fort_gmg_fill_bc
+
+! ::: -----------------------------------------------------------
+! ::: Right-hand side of the Mehrstellen discretization,
+! ::: rhs4 = rhs + h^2/12 Lap(rhs).  rhs must have its ghost cells
+! ::: filled.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_rhs4(lo, hi, &
+                               rhs4, r_l1, r_l2, r_l3, r_h1, r_h2, r_h3, &
+                               rhs , f_l1, f_l2, f_l3, f_h1, f_h2, f_h3)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3)
+      integer , intent(in   ) :: r_l1, r_l2, r_l3, r_h1, r_h2, r_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(rt), intent(inout) :: rhs4(r_l1:r_h1,r_l2:r_h2,r_l3:r_h3)
+      real(rt), intent(in   ) :: rhs (f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+
+      integer i, j, k
+
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+               rhs4(i,j,k) = rhs(i,j,k) + ( &
+                    rhs(i-1,j,k) + rhs(i+1,j,k) + &
+                    rhs(i,j-1,k) + rhs(i,j+1,k) + &
+                    rhs(i,j,k-1) + rhs(i,j,k+1) - 6.d0 * rhs(i,j,k) ) / 12.d0
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_rhs4
+
+! ::: -----------------------------------------------------------
+! ::: grad = -d(phi)/dx_dir on the faces lo:hi normal to dir (0-based),
+! ::: to second order, or to fourth order if order = 4 (which needs
+! ::: two ghost cells).
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_grad(lo, hi, &
+                               grad, g_l1, g_l2, g_l3, g_h1, g_h2, g_h3, &
+                               phi , p_l1, p_l2, p_l3, p_h1, p_h2, p_h3, &
+                               dx, dir, order)
+
+      use amrex_fort_module, only : rt => amrex_real
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), dir, order
+      integer , intent(in   ) :: g_l1, g_l2, g_l3, g_h1, g_h2, g_h3
+      integer , intent(in   ) :: p_l1, p_l2, p_l3, p_h1, p_h2, p_h3
+      real(rt), intent(inout) :: grad(g_l1:g_h1,g_l2:g_h2,g_l3:g_h3)
+      real(rt), intent(in   ) :: phi (p_l1:p_h1,p_l2:p_h2,p_l3:p_h3)
+      real(rt), intent(in   ) :: dx(3)
+
+      integer i, j, k, ii, jj, kk
+      real(rt) rdx
+
+      ii = 0
+      jj = 0
+      kk = 0
+      if (dir .eq. 0) ii = 1
+      if (dir .eq. 1) jj = 1
+      if (dir .eq. 2) kk = 1
+
+      rdx = 1.d0 / dx(dir+1)
+
+      if (order .eq. 4) then
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  grad(i,j,k) = -rdx / 24.d0 * ( &
+                       27.d0 * (phi(i,j,k) - phi(i-ii,j-jj,k-kk)) &
+                       - phi(i+ii,j+jj,k+kk) + phi(i-2*ii,j-2*jj,k-2*kk) )
+               enddo
+            enddo
+         enddo
+      else
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  grad(i,j,k) = -rdx * (phi(i,j,k) - phi(i-ii,j-jj,k-kk))
+               enddo
+            enddo
+         enddo
+      endif
+
+      end subroutine fort_gmg_grad
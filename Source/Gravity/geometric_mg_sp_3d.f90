@@ -0,0 +1,366 @@
+! ::: -----------------------------------------------------------
+! ::: Single-precision copies of the GeometricMG kernels, for the
+! ::: cycles of a solve with single_precision = 1.  They see only
+! ::: the corrections, so the boundary conditions are always the
+! ::: homogeneous ones.  dx, c1 and c2 stay in double precision and
+! ::: are rounded once per call.
+! ::: -----------------------------------------------------------
+
+! ::: -----------------------------------------------------------
+! ::: res = rhs - A phi on lo:hi, as fort_gmg_residual.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_residual_sp(lo, hi, &
+                                      res, r_l1, r_l2, r_l3, r_h1, r_h2, r_h3, &
+                                      phi, p_l1, p_l2, p_l3, p_h1, p_h2, p_h3, &
+                                      rhs, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                      dx, order)
+
+      use amrex_fort_module, only : rt => amrex_real
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), order
+      integer , intent(in   ) :: r_l1, r_l2, r_l3, r_h1, r_h2, r_h3
+      integer , intent(in   ) :: p_l1, p_l2, p_l3, p_h1, p_h2, p_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(fp), intent(inout) :: res(r_l1:r_h1,r_l2:r_h2,r_l3:r_h3)
+      real(fp), intent(in   ) :: phi(p_l1:p_h1,p_l2:p_h2,p_l3:p_h3)
+      real(fp), intent(in   ) :: rhs(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(rt), intent(in   ) :: dx(3)
+
+      integer i, j, k
+      real(fp) ax, ay, az, c6
+
+      if (order .eq. 4) then
+
+         c6 = real(1.d0 / (6.d0 * dx(1)**2), fp)
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  res(i,j,k) = rhs(i,j,k) + c6 * ( &
+                       2.0_fp * ( phi(i-1,j,k) + phi(i+1,j,k) &
+                                + phi(i,j-1,k) + phi(i,j+1,k) &
+                                + phi(i,j,k-1) + phi(i,j,k+1) ) &
+                       + phi(i-1,j-1,k) + phi(i+1,j-1,k) + phi(i-1,j+1,k) + phi(i+1,j+1,k) &
+                       + phi(i-1,j,k-1) + phi(i+1,j,k-1) + phi(i-1,j,k+1) + phi(i+1,j,k+1) &
+                       + phi(i,j-1,k-1) + phi(i,j+1,k-1) + phi(i,j-1,k+1) + phi(i,j+1,k+1) &
+                       - 24.0_fp * phi(i,j,k) )
+               enddo
+            enddo
+         enddo
+
+      else
+
+         ax = real(1.d0 / dx(1)**2, fp)
+         ay = real(1.d0 / dx(2)**2, fp)
+         az = real(1.d0 / dx(3)**2, fp)
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  res(i,j,k) = rhs(i,j,k) &
+                       + ax * (phi(i-1,j,k) - 2.0_fp*phi(i,j,k) + phi(i+1,j,k)) &
+                       + ay * (phi(i,j-1,k) - 2.0_fp*phi(i,j,k) + phi(i,j+1,k)) &
+                       + az * (phi(i,j,k-1) - 2.0_fp*phi(i,j,k) + phi(i,j,k+1))
+               enddo
+            enddo
+         enddo
+
+      endif
+
+      end subroutine fort_gmg_residual_sp
+
+! ::: -----------------------------------------------------------
+! ::: One Chebyshev step, as fort_gmg_cheby.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_cheby_sp(lo, hi, &
+                                   xnew, n_l1, n_l2, n_l3, n_h1, n_h2, n_h3, &
+                                   x   , x_l1, x_l2, x_l3, x_h1, x_h2, x_h3, &
+                                   xold, o_l1, o_l2, o_l3, o_h1, o_h2, o_h3, &
+                                   rhs , f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                   dx, order, c1, c2)
+
+      use amrex_fort_module, only : rt => amrex_real
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), order
+      integer , intent(in   ) :: n_l1, n_l2, n_l3, n_h1, n_h2, n_h3
+      integer , intent(in   ) :: x_l1, x_l2, x_l3, x_h1, x_h2, x_h3
+      integer , intent(in   ) :: o_l1, o_l2, o_l3, o_h1, o_h2, o_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(fp), intent(inout) :: xnew(n_l1:n_h1,n_l2:n_h2,n_l3:n_h3)
+      real(fp), intent(in   ) :: x   (x_l1:x_h1,x_l2:x_h2,x_l3:x_h3)
+      real(fp), intent(in   ) :: xold(o_l1:o_h1,o_l2:o_h2,o_l3:o_h3)
+      real(fp), intent(in   ) :: rhs (f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(rt), intent(in   ) :: dx(3), c1, c2
+
+      integer i, j, k
+      real(fp) ax, ay, az, c6, a1, a2, r
+
+      if (order .eq. 4) then
+
+         c6 = real(1.d0 / (6.d0 * dx(1)**2), fp)
+         a1 = real(c1, fp)
+         a2 = real(c2 * dx(1)**2 / 4.d0, fp)
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  r = rhs(i,j,k) + c6 * ( &
+                       2.0_fp * ( x(i-1,j,k) + x(i+1,j,k) &
+                                + x(i,j-1,k) + x(i,j+1,k) &
+                                + x(i,j,k-1) + x(i,j,k+1) ) &
+                       + x(i-1,j-1,k) + x(i+1,j-1,k) + x(i-1,j+1,k) + x(i+1,j+1,k) &
+                       + x(i-1,j,k-1) + x(i+1,j,k-1) + x(i-1,j,k+1) + x(i+1,j,k+1) &
+                       + x(i,j-1,k-1) + x(i,j+1,k-1) + x(i,j-1,k+1) + x(i,j+1,k+1) &
+                       - 24.0_fp * x(i,j,k) )
+                  xnew(i,j,k) = x(i,j,k) + a1 * (x(i,j,k) - xold(i,j,k)) + a2 * r
+               enddo
+            enddo
+         enddo
+
+      else
+
+         ax = real(1.d0 / dx(1)**2, fp)
+         ay = real(1.d0 / dx(2)**2, fp)
+         az = real(1.d0 / dx(3)**2, fp)
+         a1 = real(c1, fp)
+         a2 = real(c2 / (2.d0 * (1.d0/dx(1)**2 + 1.d0/dx(2)**2 + 1.d0/dx(3)**2)), fp)
+
+         do k = lo(3), hi(3)
+            do j = lo(2), hi(2)
+               do i = lo(1), hi(1)
+                  r = rhs(i,j,k) &
+                       + ax * (x(i-1,j,k) - 2.0_fp*x(i,j,k) + x(i+1,j,k)) &
+                       + ay * (x(i,j-1,k) - 2.0_fp*x(i,j,k) + x(i,j+1,k)) &
+                       + az * (x(i,j,k-1) - 2.0_fp*x(i,j,k) + x(i,j,k+1))
+                  xnew(i,j,k) = x(i,j,k) + a1 * (x(i,j,k) - xold(i,j,k)) + a2 * r
+               enddo
+            enddo
+         enddo
+
+      endif
+
+      end subroutine fort_gmg_cheby_sp
+
+! ::: -----------------------------------------------------------
+! ::: crse = average of the eight fine cells, as fort_gmg_restrict.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_restrict_sp(lo, hi, &
+                                      crse, c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                      fine, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3)
+
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3)
+      integer , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      real(fp), intent(inout) :: crse(c_l1:c_h1,c_l2:c_h2,c_l3:c_h3)
+      real(fp), intent(in   ) :: fine(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+
+      integer i, j, k, ii, jj, kk
+
+      do k = lo(3), hi(3)
+         kk = 2*k
+         do j = lo(2), hi(2)
+            jj = 2*j
+            do i = lo(1), hi(1)
+               ii = 2*i
+               crse(i,j,k) = 0.125_fp * ( &
+                    fine(ii,jj  ,kk  ) + fine(ii+1,jj  ,kk  ) + &
+                    fine(ii,jj+1,kk  ) + fine(ii+1,jj+1,kk  ) + &
+                    fine(ii,jj  ,kk+1) + fine(ii+1,jj  ,kk+1) + &
+                    fine(ii,jj+1,kk+1) + fine(ii+1,jj+1,kk+1) )
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_restrict_sp
+
+! ::: -----------------------------------------------------------
+! ::: Trilinear interpolation of crse onto fine, as fort_gmg_interp.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_interp_sp(lo, hi, &
+                                    fine, f_l1, f_l2, f_l3, f_h1, f_h2, f_h3, &
+                                    crse, c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                    add)
+
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), add
+      integer , intent(in   ) :: f_l1, f_l2, f_l3, f_h1, f_h2, f_h3
+      integer , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+      real(fp), intent(inout) :: fine(f_l1:f_h1,f_l2:f_h2,f_l3:f_h3)
+      real(fp), intent(in   ) :: crse(c_l1:c_h1,c_l2:c_h2,c_l3:c_h3)
+
+      integer i, j, k, ic, jc, kc, io, jo, ko
+      real(fp) val
+
+      do k = lo(3), hi(3)
+         kc = k / 2
+         ko = 2*(k - 2*kc) - 1
+         do j = lo(2), hi(2)
+            jc = j / 2
+            jo = 2*(j - 2*jc) - 1
+            do i = lo(1), hi(1)
+               ic = i / 2
+               io = 2*(i - 2*ic) - 1
+
+               val = ( 27.0_fp *  crse(ic   ,jc   ,kc   ) &
+                     +  9.0_fp * (crse(ic+io,jc   ,kc   ) &
+                                + crse(ic   ,jc+jo,kc   ) &
+                                + crse(ic   ,jc   ,kc+ko)) &
+                     +  3.0_fp * (crse(ic+io,jc+jo,kc   ) &
+                                + crse(ic+io,jc   ,kc+ko) &
+                                + crse(ic   ,jc+jo,kc+ko)) &
+                     +            crse(ic+io,jc+jo,kc+ko) ) / 64.0_fp
+
+               if (add .eq. 1) then
+                  fine(i,j,k) = fine(i,j,k) + val
+               else
+                  fine(i,j,k) = val
+               endif
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_interp_sp
+
+! ::: -----------------------------------------------------------
+! ::: The homogeneous case of fort_gmg_fill_bc: phi = 0 on the
+! ::: Dirichlet faces and zero normal gradient on the Neumann ones.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_fill_bc_sp(lo, hi, domlo, domhi, &
+                                     phi, p_l1, p_l2, p_l3, p_h1, p_h2, p_h3, &
+                                     bc)
+
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), domlo(3), domhi(3), bc(6)
+      integer , intent(in   ) :: p_l1, p_l2, p_l3, p_h1, p_h2, p_h3
+      real(fp), intent(inout) :: phi(p_l1:p_h1,p_l2:p_h2,p_l3:p_h3)
+
+      integer dir, side, ig, jg, kg, ii, jj, kk
+      integer glo(3), ghi(3), n(3)
+
+      do dir = 1, 3
+         do side = 0, 1
+
+            if (bc(2*dir-1+side) .eq. 0) cycle
+
+            if (side .eq. 0) then
+               if (lo(dir) .ne. domlo(dir)) cycle
+            else
+               if (hi(dir) .ne. domhi(dir)) cycle
+            endif
+
+            glo = lo
+            ghi = hi
+            n   = 0
+            glo(1:dir-1) = lo(1:dir-1) - 1
+            ghi(1:dir-1) = hi(1:dir-1) + 1
+            if (side .eq. 0) then
+               glo(dir) = lo(dir) - 1
+               ghi(dir) = lo(dir) - 1
+               n(dir)   = 1
+            else
+               glo(dir) = hi(dir) + 1
+               ghi(dir) = hi(dir) + 1
+               n(dir)   = -1
+            endif
+
+            do kg = glo(3), ghi(3)
+               kk = kg + n(3)
+               do jg = glo(2), ghi(2)
+                  jj = jg + n(2)
+                  do ig = glo(1), ghi(1)
+                     ii = ig + n(1)
+                     if (bc(2*dir-1+side) .eq. 1) then
+                        phi(ig,jg,kg) = -phi(ii,jj,kk)
+                     else
+                        phi(ig,jg,kg) = phi(ii,jj,kk)
+                     endif
+                  enddo
+               enddo
+            enddo
+
+         enddo
+      enddo
+
+      end subroutine fort_gmg_fill_bc_sp
+
+! ::: -----------------------------------------------------------
+! ::: dst = src rounded to single precision, on lo:hi.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_to_single(lo, hi, &
+                                    dst, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                    src, s_l1, s_l2, s_l3, s_h1, s_h2, s_h3)
+
+      use amrex_fort_module, only : rt => amrex_real
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3)
+      integer , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+      integer , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+      real(fp), intent(inout) :: dst(d_l1:d_h1,d_l2:d_h2,d_l3:d_h3)
+      real(rt), intent(in   ) :: src(s_l1:s_h1,s_l2:s_h2,s_l3:s_h3)
+
+      integer i, j, k
+
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+               dst(i,j,k) = real(src(i,j,k), fp)
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_to_single
+
+! ::: -----------------------------------------------------------
+! ::: dst += src (or dst = src if add = 0) in double precision,
+! ::: on lo:hi.
+! ::: -----------------------------------------------------------
+
+      subroutine fort_gmg_to_double(lo, hi, &
+                                    dst, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                    src, s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
+                                    add)
+
+      use amrex_fort_module, only : rt => amrex_real
+      use iso_c_binding, only : fp => c_float
+      implicit none
+
+      integer , intent(in   ) :: lo(3), hi(3), add
+      integer , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+      integer , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+      real(rt), intent(inout) :: dst(d_l1:d_h1,d_l2:d_h2,d_l3:d_h3)
+      real(fp), intent(in   ) :: src(s_l1:s_h1,s_l2:s_h2,s_l3:s_h3)
+
+      integer i, j, k
+
+      do k = lo(3), hi(3)
+         do j = lo(2), hi(2)
+            do i = lo(1), hi(1)
+               if (add .eq. 1) then
+                  dst(i,j,k) = dst(i,j,k) + real(src(i,j,k), rt)
+               else
+                  dst(i,j,k) = real(src(i,j,k), rt)
+               endif
+            enddo
+         enddo
+      enddo
+
+      end subroutine fort_gmg_to_double
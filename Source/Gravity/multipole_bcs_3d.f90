@@ -0,0 +1,361 @@
+
+     ! ************************************************************************************
+     ! Loops over the particles and adds their monopole contribution to phi outside the boundary
+     ! ************************************************************************************
+
+     subroutine fort_add_monopole_bcs(lo,hi,domlo,domhi, &
+                                      np,part_locs,part_mass, &
+                                      phi,phi_l1,phi_l2,phi_l3,phi_h1,phi_h2,phi_h3,dx);
+
+     use amrex_fort_module, only : rt => amrex_real
+     use fundamental_constants_module, only : Gconst
+ 
+     implicit none
+
+     integer         ,intent(in   ) :: lo(3),hi(3),domlo(3),domhi(3),np
+     integer         ,intent(in   ) :: phi_l1,phi_l2,phi_l3,phi_h1,phi_h2,phi_h3
+     real(rt),intent(in   ) :: part_locs(0:3*np-1)
+     real(rt),intent(in   ) :: part_mass(0:  np-1)
+     real(rt),intent(  out) :: phi(phi_l1:phi_h1,phi_l2:phi_h2,phi_l3:phi_h3)
+     real(rt),intent(in   ) :: dx(3)
+
+     ! Local variables
+     integer          :: i,j,k,n
+     real(rt) :: x,y,z,r
+     real(rt) :: x0,y0,z0
+
+     phi = 0.d0
+
+     ! Define phi = -G M / r where r is distance from particle and M is mass of particle
+
+     do k = lo(3)-1,hi(3)+1
+         do j = lo(2)-1,hi(2)+1
+             do i = lo(1)-1,hi(1)+1
+
+                   if (i.lt.domlo(1) .or. i.gt.domhi(1) .or. &
+                       j.lt.domlo(2) .or. j.gt.domhi(2) .or. &
+                       k.lt.domlo(3) .or. k.gt.domhi(3)) then
+
+                       if (i.lt.domlo(1)) then
+                           x0 = (dble(i+1))*dx(1)
+                       else if (i.gt.domhi(1)) then
+                           x0 = (dble(i))*dx(1)
+                       else 
+                           x0 = (dble(i)+0.5d0)*dx(1)
+                       end if
+    
+                       if (j.lt.domlo(2)) then
+                           y0 = (dble(j+1))*dx(2)
+                       else if (j.gt.domhi(2)) then
+                           y0 = (dble(j))*dx(2)
+                       else 
+                           y0 = (dble(j)+0.5d0)*dx(2)
+                       end if
+    
+                       if (k.lt.domlo(3)) then
+                           z0 = (dble(k+1))*dx(3)
+                       else if (k.gt.domhi(3)) then
+                           z0 = (dble(k))*dx(3)
+                       else 
+                           z0 = (dble(k)+0.5d0)*dx(3)
+                       end if
+
+                       do n = 0, np-1
+                           x = x0 - part_locs(3*n  )
+                           y = y0 - part_locs(3*n+1)
+                           z = z0 - part_locs(3*n+2)
+                           r = sqrt(x*x + y*y + z*z)
+                           phi(i,j,k) = phi(i,j,k) - Gconst * part_mass(n) / r 
+                       end do
+ 
+                   end if
+              end do
+         end do
+     end do
+ 
+     end subroutine fort_add_monopole_bcs
+
+     ! ************************************************************************************
+     ! Multipole expansion of the potential of an isolated mass distribution.  With
+     ! r' and r scaled by rscale, and x = cos(theta), the moments are
+     !
+     !   qc(l,m) = sum mass (r'/rscale)^l P_l^m(x') cos(m phi')
+     !   qs(l,m) = sum mass (r'/rscale)^l P_l^m(x') sin(m phi')
+     !
+     ! and outside the mass, by the addition theorem,
+     !
+     !   phi = -G/rscale sum_l (rscale/r)^(l+1) sum_m c_lm P_l^m(x) (qc cos(m phi) + qs sin(m phi))
+     !
+     ! with c_l0 = 1 and c_lm = 2 (l-m)!/(l+m)!.  Both sums are additive, so each rank
+     ! accumulates the moments of its own cells and particles and a single reduction
+     ! of 2 (lmax+1)^2 numbers gives the global moments.  The series only converges
+     ! where r is larger than rmax, the radius that encloses all the mass, which the
+     ! moment routines also return.
+     ! ************************************************************************************
+
+     module multipole_module
+
+     use amrex_fort_module, only : rt => amrex_real
+
+     implicit none
+
+     contains
+
+     ! P_l^m(cos theta) cos(m phi) and sin(m phi) for 0 <= m <= l <= lmax at (x,y,z)
+     ! relative to the center, and r in units of rscale.
+     subroutine multipole_basis(x,y,z,rscale,lmax,r,pc,ps)
+
+     real(rt),intent(in   ) :: x,y,z,rscale
+     integer ,intent(in   ) :: lmax
+     real(rt),intent(  out) :: r
+     real(rt),intent(  out) :: pc(0:lmax,0:lmax), ps(0:lmax,0:lmax)
+
+     integer  :: l,m
+     real(rt) :: rxy,ct,st,cp,sp,cm,sm,tmp
+     real(rt) :: plm(0:lmax,0:lmax)
+
+     rxy = sqrt(x*x + y*y)
+     r   = sqrt(rxy*rxy + z*z)
+
+     if (r .gt. 0.d0) then
+        ct = z   / r
+        st = rxy / r
+     else
+        ct = 1.d0
+        st = 0.d0
+     end if
+
+     if (rxy .gt. 0.d0) then
+        cp = x / rxy
+        sp = y / rxy
+     else
+        cp = 1.d0
+        sp = 0.d0
+     end if
+
+     r = r / rscale
+
+     ! Associated Legendre functions, without the Condon-Shortley phase
+     plm = 0.d0
+     plm(0,0) = 1.d0
+     do m = 1, lmax
+        plm(m,m) = plm(m-1,m-1) * dble(2*m-1) * st
+     end do
+     do m = 0, lmax-1
+        plm(m+1,m) = ct * dble(2*m+1) * plm(m,m)
+     end do
+     do m = 0, lmax
+        do l = m+2, lmax
+           plm(l,m) = (dble(2*l-1) * ct * plm(l-1,m) - dble(l+m-1) * plm(l-2,m)) / dble(l-m)
+        end do
+     end do
+
+     cm = 1.d0
+     sm = 0.d0
+     do m = 0, lmax
+        do l = m, lmax
+           pc(l,m) = plm(l,m) * cm
+           ps(l,m) = plm(l,m) * sm
+        end do
+        tmp = cm*cp - sm*sp
+        sm  = sm*cp + cm*sp
+        cm  = tmp
+     end do
+
+     end subroutine multipole_basis
+
+     subroutine add_point_moments(x,y,z,mass,rscale,lmax,qc,qs)
+
+     real(rt),intent(in   ) :: x,y,z,mass,rscale
+     integer ,intent(in   ) :: lmax
+     real(rt),intent(inout) :: qc(0:lmax,0:lmax), qs(0:lmax,0:lmax)
+
+     integer  :: l,m
+     real(rt) :: r,rl
+     real(rt) :: pc(0:lmax,0:lmax), ps(0:lmax,0:lmax)
+
+     call multipole_basis(x,y,z,rscale,lmax,r,pc,ps)
+
+     rl = mass
+     do l = 0, lmax
+        do m = 0, l
+           qc(l,m) = qc(l,m) + rl * pc(l,m)
+           qs(l,m) = qs(l,m) + rl * ps(l,m)
+        end do
+        rl = rl * r
+     end do
+
+     end subroutine add_point_moments
+
+     end module multipole_module
+
+     ! ************************************************************************************
+     ! Adds the moments of the density in the cells lo:hi
+     ! ************************************************************************************
+
+     subroutine fort_add_grid_multipole_moments(lo,hi, &
+                                                rho,r_l1,r_l2,r_l3,r_h1,r_h2,r_h3, &
+                                                dx,problo,center,rscale,lmax,qc,qs,rmax)
+
+     use amrex_fort_module, only : rt => amrex_real
+     use multipole_module, only : add_point_moments
+
+     implicit none
+
+     integer ,intent(in   ) :: lo(3),hi(3),lmax
+     integer ,intent(in   ) :: r_l1,r_l2,r_l3,r_h1,r_h2,r_h3
+     real(rt),intent(in   ) :: rho(r_l1:r_h1,r_l2:r_h2,r_l3:r_h3)
+     real(rt),intent(in   ) :: dx(3),problo(3),center(3),rscale
+     real(rt),intent(inout) :: qc(0:lmax,0:lmax), qs(0:lmax,0:lmax)
+     real(rt),intent(inout) :: rmax
+
+     integer  :: i,j,k
+     real(rt) :: x,y,z,vol,hdiag
+
+     vol   = dx(1)*dx(2)*dx(3)
+     hdiag = 0.5d0 * sqrt(dx(1)**2 + dx(2)**2 + dx(3)**2)
+
+     do k = lo(3),hi(3)
+         z = problo(3) + (dble(k)+0.5d0)*dx(3) - center(3)
+         do j = lo(2),hi(2)
+             y = problo(2) + (dble(j)+0.5d0)*dx(2) - center(2)
+             do i = lo(1),hi(1)
+                 x = problo(1) + (dble(i)+0.5d0)*dx(1) - center(1)
+                 if (rho(i,j,k) .ne. 0.d0) then
+                     call add_point_moments(x,y,z,rho(i,j,k)*vol,rscale,lmax,qc,qs)
+                     rmax = max(rmax, sqrt(x*x + y*y + z*z) + hdiag)
+                 end if
+             end do
+         end do
+     end do
+
+     end subroutine fort_add_grid_multipole_moments
+
+     ! ************************************************************************************
+     ! Adds the moments of np point masses
+     ! ************************************************************************************
+
+     subroutine fort_add_particle_multipole_moments(np,part_locs,part_mass, &
+                                                    center,rscale,lmax,qc,qs,rmax)
+
+     use amrex_fort_module, only : rt => amrex_real
+     use multipole_module, only : add_point_moments
+
+     implicit none
+
+     integer ,intent(in   ) :: np,lmax
+     real(rt),intent(in   ) :: part_locs(0:3*np-1)
+     real(rt),intent(in   ) :: part_mass(0:  np-1)
+     real(rt),intent(in   ) :: center(3),rscale
+     real(rt),intent(inout) :: qc(0:lmax,0:lmax), qs(0:lmax,0:lmax)
+     real(rt),intent(inout) :: rmax
+
+     integer  :: n
+     real(rt) :: x,y,z
+
+     do n = 0, np-1
+        x = part_locs(3*n  ) - center(1)
+        y = part_locs(3*n+1) - center(2)
+        z = part_locs(3*n+2) - center(3)
+        call add_point_moments(x,y,z,part_mass(n),rscale,lmax,qc,qs)
+        rmax = max(rmax, sqrt(x*x + y*y + z*z))
+     end do
+
+     end subroutine fort_add_particle_multipole_moments
+
+     ! ************************************************************************************
+     ! Sets phi outside the domain from the multipole moments
+     ! ************************************************************************************
+
+     subroutine fort_add_multipole_bcs(lo,hi,domlo,domhi, &
+                                       lmax,qc,qs,center,rscale, &
+                                       phi,phi_l1,phi_l2,phi_l3,phi_h1,phi_h2,phi_h3,dx,problo)
+
+     use amrex_fort_module, only : rt => amrex_real
+     use fundamental_constants_module, only : Gconst
+     use multipole_module, only : multipole_basis
+
+     implicit none
+
+     integer ,intent(in   ) :: lo(3),hi(3),domlo(3),domhi(3),lmax
+     integer ,intent(in   ) :: phi_l1,phi_l2,phi_l3,phi_h1,phi_h2,phi_h3
+     real(rt),intent(in   ) :: qc(0:lmax,0:lmax), qs(0:lmax,0:lmax)
+     real(rt),intent(in   ) :: center(3),rscale
+     real(rt),intent(  out) :: phi(phi_l1:phi_h1,phi_l2:phi_h2,phi_l3:phi_h3)
+     real(rt),intent(in   ) :: dx(3),problo(3)
+
+     ! Local variables
+     integer  :: i,j,k,l,m,n
+     real(rt) :: x0,y0,z0,r,rinv,rl,sum_l
+     real(rt) :: c(0:lmax,0:lmax)
+     real(rt) :: pc(0:lmax,0:lmax), ps(0:lmax,0:lmax)
+
+     do l = 0, lmax
+        c(l,0) = 1.d0
+        do m = 1, l
+           ! 2 (l-m)! / (l+m)!
+           c(l,m) = 2.d0
+           do n = l-m+1, l+m
+              c(l,m) = c(l,m) / dble(n)
+           end do
+        end do
+     end do
+
+     phi = 0.d0
+
+     ! Evaluate the expansion on the faces of the domain, as for the old monopole bcs
+
+     do k = lo(3)-1,hi(3)+1
+         do j = lo(2)-1,hi(2)+1
+             do i = lo(1)-1,hi(1)+1
+
+                   if (i.lt.domlo(1) .or. i.gt.domhi(1) .or. &
+                       j.lt.domlo(2) .or. j.gt.domhi(2) .or. &
+                       k.lt.domlo(3) .or. k.gt.domhi(3)) then
+
+                       if (i.lt.domlo(1)) then
+                           x0 = (dble(i+1))*dx(1)
+                       else if (i.gt.domhi(1)) then
+                           x0 = (dble(i))*dx(1)
+                       else 
+                           x0 = (dble(i)+0.5d0)*dx(1)
+                       end if
+    
+                       if (j.lt.domlo(2)) then
+                           y0 = (dble(j+1))*dx(2)
+                       else if (j.gt.domhi(2)) then
+                           y0 = (dble(j))*dx(2)
+                       else 
+                           y0 = (dble(j)+0.5d0)*dx(2)
+                       end if
+    
+                       if (k.lt.domlo(3)) then
+                           z0 = (dble(k+1))*dx(3)
+                       else if (k.gt.domhi(3)) then
+                           z0 = (dble(k))*dx(3)
+                       else 
+                           z0 = (dble(k)+0.5d0)*dx(3)
+                       end if
+
+                       call multipole_basis(problo(1) + x0 - center(1), &
+                                            problo(2) + y0 - center(2), &
+                                            problo(3) + z0 - center(3), &
+                                            rscale,lmax,r,pc,ps)
+
+                       rinv = 1.d0 / r
+                       rl   = rinv
+                       do l = 0, lmax
+                           sum_l = 0.d0
+                           do m = 0, l
+                               sum_l = sum_l + c(l,m) * (qc(l,m)*pc(l,m) + qs(l,m)*ps(l,m))
+                           end do
+                           phi(i,j,k) = phi(i,j,k) - Gconst * rl * sum_l / rscale
+                           rl = rl * rinv
+                       end do
+ 
+                   end if
+              end do
+         end do
+     end do
+ 
+     end subroutine fort_add_multipole_bcs
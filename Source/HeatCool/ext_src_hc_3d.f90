@@ -70,6 +70,7 @@ subroutine ext_src_hc(lo, hi, old_state, os_l1, os_l2, os_l3, os_h1, os_h2, os_h
                                          src_l3:src_h3, NVAR)
 
     real(rt), allocatable :: tmp_state(:,:,:,:)
+    real(rt), allocatable :: hc_cost(:,:,:,:)
 
     integer          :: i, j, k
     integer          :: src_lo(3),src_hi(3)
@@ -80,6 +81,10 @@ subroutine ext_src_hc(lo, hi, old_state, os_l1, os_l2, os_l3, os_h1, os_h2, os_h
     allocate(tmp_state(ns_l1:ns_h1,ns_l2:ns_h2,ns_l3:ns_h3,NVAR))
     tmp_state(:,:,:,:) = new_state(:,:,:,:)
 
+    ! The integration cost is not recorded for the predictor-corrector sources
+    allocate(hc_cost(src_l1:src_h1,src_l2:src_h2,src_l3:src_h3,2))
+    hc_cost(:,:,:,:) = 0.d0
+
      a = 1.d0 / (1.d0+z)
 
     ! Note that when we call this routine to compute the "old" source,
@@ -101,10 +106,12 @@ subroutine ext_src_hc(lo, hi, old_state, os_l1, os_l2, os_l3, os_h1, os_h2, os_h
     if (heat_cool_type .eq. 1) then
         call integrate_state_hc(src_lo,src_hi,tmp_state,ns_l1,ns_l2,ns_l3, ns_h1,ns_h2,ns_h3, &
                                               new_diag ,nd_l1,nd_l2,nd_l3, nd_h1,nd_h2,nd_h3, &
+                                              hc_cost  ,src_l1,src_l2,src_l3,src_h1,src_h2,src_h3, &
                                 a,half_dt,min_iter,max_iter)
     else if (heat_cool_type .eq. 3) then
         call integrate_state_vode(src_lo,src_hi,tmp_state,ns_l1,ns_l2,ns_l3, ns_h1,ns_h2,ns_h3, &
                                                 new_diag ,nd_l1,nd_l2,nd_l3, nd_h1,nd_h2,nd_h3, &
+                                                hc_cost  ,src_l1,src_l2,src_l3,src_h1,src_h2,src_h3, &
                                   a,half_dt,min_iter,max_iter)
     endif
     do k = src_l3, src_h3
@@ -5,12 +5,10 @@ subroutine f_rhs(num_eq, time, e_in, energy, rpar, ipar)
       use fundamental_constants_module, only: e_to_cgs, density_to_cgs, & 
                                               heat_from_cgs
       use eos_module, only: iterate_ne
-      use atomic_rates_module, ONLY: TCOOLMIN, TCOOLMAX, NCOOLTAB, deltaT, &
-                                     MPROTON, XHYDROGEN, &
-                                     AlphaHp, AlphaHep, AlphaHepp, Alphad, &
-                                     GammaeH0, GammaeHe0, GammaeHep, &
-                                     BetaH0, BetaHe0, BetaHep, Betaff1, Betaff4, &
-                                     RecHp, RecHep, RecHepp, &
+      use atomic_rates_module, ONLY: TCOOLMAX, MPROTON, XHYDROGEN, &
+                                     NRATES, interp_rates, &
+                                     IBH0, IBHE0, IBHEP, IBFF1, IBFF4, &
+                                     IRHP, IRHEP, IRHEPP, &
                                      eh0, ehe0, ehep
 
       use vode_aux_module       , only: z_vode, rho_vode, T_vode, ne_vode, i_vode, j_vode, k_vode
@@ -23,13 +21,11 @@ subroutine f_rhs(num_eq, time, e_in, energy, rpar, ipar)
 
       real(rt), parameter :: compt_c = 1.01765467d-37, T_cmb = 2.725d0
 
-      real(rt) :: logT, tmp, fhi, flo
-      real(rt) :: ahp, ahep, ahepp, ad, geh0, gehe0, gehep
-      real(rt) :: bh0, bhe0, bhep, bff1, bff4, rhp, rhep, rhepp
+      real(rt) :: logT
+      real(rt) :: rates(NRATES)
       real(rt) :: lambda_c, lambda_ff, lambda, heat
       real(rt) :: rho, U, a
       real(rt) :: nh, nh0, nhp, nhe0, nhep, nhepp
-      integer :: j
 
       if (e_in(1) .lt. 0.d0) &
          e_in(1) = tiny(e_in(1))
@@ -70,36 +66,13 @@ subroutine f_rhs(num_eq, time, e_in, energy, rpar, ipar)
          return
       endif
 
-      ! Temperature floor
-      if (logT .le. TCOOLMIN) logT = TCOOLMIN + 0.5d0*deltaT
-
-      ! Interpolate rates
-      tmp = (logT-TCOOLMIN)/deltaT
-      j = int(tmp)
-      fhi = tmp - j
-      flo = 1.0d0 - fhi
-      j = j + 1 ! F90 arrays start with 1
-
-      ahp   = flo*AlphaHp  (j) + fhi*AlphaHp  (j+1)
-      ahep  = flo*AlphaHep (j) + fhi*AlphaHep (j+1)
-      ahepp = flo*AlphaHepp(j) + fhi*AlphaHepp(j+1)
-      ad    = flo*Alphad   (j) + fhi*Alphad   (j+1)
-      geh0  = flo*GammaeH0 (j) + fhi*GammaeH0 (j+1)
-      gehe0 = flo*GammaeHe0(j) + fhi*GammaeHe0(j+1)
-      gehep = flo*GammaeHep(j) + fhi*GammaeHep(j+1)
-      bh0   = flo*BetaH0   (j) + fhi*BetaH0   (j+1)
-      bhe0  = flo*BetaHe0  (j) + fhi*BetaHe0  (j+1)
-      bhep  = flo*BetaHep  (j) + fhi*BetaHep  (j+1)
-      bff1  = flo*Betaff1  (j) + fhi*Betaff1  (j+1)
-      bff4  = flo*Betaff4  (j) + fhi*Betaff4  (j+1)
-      rhp   = flo*RecHp    (j) + fhi*RecHp    (j+1)
-      rhep  = flo*RecHep   (j) + fhi*RecHep   (j+1)
-      rhepp = flo*RecHepp  (j) + fhi*RecHepp  (j+1)
+      ! Interpolate rates (the temperature floor is applied in interp_rates)
+      call interp_rates(logT, NRATES, rates)
 
       ! Cooling: 
-      lambda = ( bh0*nh0 + bhe0*nhe0 + bhep*nhep + &
-                 rhp*nhp + rhep*nhep + rhepp*nhepp + &
-                 bff1*(nhp+nhep) + bff4*nhepp ) * ne_vode
+      lambda = ( rates(IBH0)*nh0 + rates(IBHE0)*nhe0 + rates(IBHEP)*nhep + &
+                 rates(IRHP)*nhp + rates(IRHEP)*nhep + rates(IRHEPP)*nhepp + &
+                 rates(IBFF1)*(nhp+nhep) + rates(IBFF4)*nhepp ) * ne_vode
 
       lambda_c = compt_c*T_cmb**4*ne_vode*(T_vode - T_cmb*(1.0d0+z_vode))*(1.0d0 + z_vode)**4   ! Compton cooling
       lambda = lambda + lambda_c
@@ -61,23 +61,56 @@ subroutine ext_src_jf(lo, hi, old_state, old_state_l1, old_state_l2, &
     src = 0.d0
 end subroutine ext_src_jf
 
-subroutine integrate_state(lo, hi, state, state_l1, state_l2, &
-                           state_l3, state_h1, state_h2, state_h3, &
-                           dx, a, half_dt) bind(C, name="integrate_state")
+subroutine integrate_state(lo, hi, &
+                           state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
+                           diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                           hc_cost , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                           a, half_dt, min_iter, max_iter) &
+                           bind(C, name="integrate_state")
 
     use amrex_fort_module, only : rt => amrex_real
     use meth_params_module, only : NVAR
 
     implicit none
 
-    integer, intent(in) :: lo(3), hi(3)
-    integer, intent(in) :: state_l1, state_l2, state_l3
-    integer, intent(in) :: state_h1, state_h2, state_h3
-    real(rt), intent(inout) :: state(state_l1:state_h1, state_l2:state_h2, &
-                                             state_l3:state_h3, NVAR)
-    real(rt), intent(in) :: dx(3), a, half_dt
+    integer         , intent(in   ) :: lo(3), hi(3)
+    integer         , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
+    integer         , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer         , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+    real(rt), intent(inout) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
+    real(rt), intent(inout) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(inout) ::  hc_cost(c_l1:c_h1, c_l2:c_h2,c_l3:c_h3, 2)
+    real(rt), intent(in   ) ::  a, half_dt
+    integer         , intent(inout) :: min_iter, max_iter
 
 end subroutine integrate_state
+
+subroutine integrate_state_with_source(lo, hi, &
+                                       state_old, so_l1, so_l2, so_l3, so_h1, so_h2, so_h3, &
+                                       state_new, sn_l1, sn_l2, sn_l3, sn_h1, sn_h2, sn_h3, &
+                                       diag_eos , d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                       hc_cost  , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                       a, dt, min_iter, max_iter) &
+                                       bind(C, name="integrate_state_with_source")
+
+    use amrex_fort_module, only : rt => amrex_real
+    use meth_params_module, only : NVAR
+
+    implicit none
+
+    integer         , intent(in   ) :: lo(3), hi(3)
+    integer         , intent(in   ) :: so_l1, so_l2, so_l3, so_h1, so_h2, so_h3
+    integer         , intent(in   ) :: sn_l1, sn_l2, sn_l3, sn_h1, sn_h2, sn_h3
+    integer         , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer         , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+    real(rt), intent(in   ) :: state_old(so_l1:so_h1, so_l2:so_h2,so_l3:so_h3, NVAR)
+    real(rt), intent(inout) :: state_new(sn_l1:sn_h1, sn_l2:sn_h2,sn_l3:sn_h3, NVAR)
+    real(rt), intent(inout) ::  diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(inout) ::   hc_cost(c_l1:c_h1, c_l2:c_h2,c_l3:c_h3, 2)
+    real(rt), intent(in   ) :: a, dt
+    integer         , intent(inout) :: min_iter, max_iter
+
+end subroutine integrate_state_with_source
  
 
 
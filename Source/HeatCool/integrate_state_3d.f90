@@ -1,6 +1,7 @@
 subroutine integrate_state(lo, hi, &
                            state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
                            diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                           hc_cost , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
                            a, half_dt, min_iter, max_iter) &
                            bind(C, name="integrate_state")
 
@@ -17,6 +18,9 @@ subroutine integrate_state(lo, hi, &
 !       The state vars
 !   diag_eos* : double arrays
 !       Temp and Ne
+!   hc_cost* : double arrays
+!       Per-cell cost of the integration, incremented here:
+!       (1) number of RHS evaluations, (2) number of integrator steps
 !   src_* : double arrays
 !       The source terms to be added to state (iterative approx.)
 !   double array (3)
@@ -40,18 +44,22 @@ subroutine integrate_state(lo, hi, &
     integer         , intent(in   ) :: lo(3), hi(3)
     integer         , intent(in   ) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
     integer         , intent(in   ) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer         , intent(in   ) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
     real(rt), intent(inout) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
     real(rt), intent(inout) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(inout) ::  hc_cost(c_l1:c_h1, c_l2:c_h2,c_l3:c_h3, 2)
     real(rt), intent(in   ) ::  a, half_dt
     integer         , intent(inout) :: min_iter, max_iter
 
     if (heat_cool_type .eq. 1) then
         call integrate_state_hc(lo, hi, state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
                                         diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                        hc_cost , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
                                 a, half_dt, min_iter, max_iter)
     else if (heat_cool_type .eq. 3) then
         call integrate_state_vode(lo, hi, state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
                                           diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                          hc_cost , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
                                   a, half_dt, min_iter, max_iter)
 
     end if
@@ -1,6 +1,7 @@
 subroutine integrate_state_hc(lo, hi, &
                               state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
                               diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                              hc_cost , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
                               a, half_dt, min_iter, max_iter)
 !
 !   Calculates the sources to be added later on.
@@ -15,6 +16,8 @@ subroutine integrate_state_hc(lo, hi, &
 !       The state vars
 !   diag_eos_* : double arrays
 !       Temp and Ne
+!   hc_cost_* : double arrays
+!       Incremented by the number of calls to hc_rates and of sub-steps per cell
 !   src_* : doubles arrays
 !       The source terms to be added to state (iterative approx.)
 !   double array (3)
@@ -44,8 +47,10 @@ subroutine integrate_state_hc(lo, hi, &
     integer         , intent(in) :: lo(3), hi(3)
     integer         , intent(in) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
     integer         , intent(in) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer         , intent(in) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
     real(rt), intent(inout) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
     real(rt), intent(inout) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(inout) ::  hc_cost(c_l1:c_h1, c_l2:c_h2,c_l3:c_h3, 2)
     real(rt), intent(in)    :: a, half_dt
     integer         , intent(inout) :: max_iter, min_iter
 
@@ -53,6 +58,7 @@ subroutine integrate_state_hc(lo, hi, &
     real(rt), parameter :: xacc = 1.0d-3
 
     integer :: i, j, k, n, iter, nsteps, cnt
+    integer :: nrhs, nsub
     real(rt) :: z, rho, T, ne
     real(rt) :: T_orig, rho_e_orig, ne_orig, e_int_old, De_int
     real(rt) :: T_first, ne_first, src_first
@@ -92,6 +98,8 @@ subroutine integrate_state_hc(lo, hi, &
 
                 e_int = rho_e_orig/rho
                 call hc_rates(z, rho, e_int, T, ne, src_new, prnt_cell)
+                nrhs = 1
+                nsub = 0
                 T_first   = T
                 ne_first  = ne
                 src_first = src_new
@@ -111,6 +119,7 @@ subroutine integrate_state_hc(lo, hi, &
 
                   do n = 1, nsteps
 
+                    nsub = nsub + 1
                     done_iter = .false.
                     e_int_old = e_int
                     e_int     = rho_e/rho
@@ -121,6 +130,7 @@ subroutine integrate_state_hc(lo, hi, &
                        src_new = src_first
                     else
                        call hc_rates(z, rho, e_int, T, ne, src_new, prnt_cell)
+                       nrhs = nrhs + 1
                     end if
 
                     if ( (rho_e+delta_t*src_new/a) .gt. 0.0d0) then 
@@ -142,6 +152,7 @@ subroutine integrate_state_hc(lo, hi, &
                           do
                              cnt = cnt + 1
                              call hc_rates(z, rho, e_int, T, ne, src_new, prnt_cell)
+                             nrhs = nrhs + 1
                              if (abs(delta_t*src_new/a)/rho .lt. xacc) EXIT
                              if (cnt .gt. 40) then 
                                 print*, 'BISECTION problem in cell:',i,j,k,iter,n
@@ -203,6 +214,9 @@ subroutine integrate_state_hc(lo, hi, &
                 diag_eos(i,j,k,TEMP_COMP) = T
                 diag_eos(i,j,k,  NE_COMP) = ne
 
+                hc_cost(i,j,k,1) = hc_cost(i,j,k,1) + nrhs
+                hc_cost(i,j,k,2) = hc_cost(i,j,k,2) + nsub
+
                 if (state(i,j,k,UEINT) .lt. 0.d0) then
                     print *,'(rho e) exiting strang integration negative ',i,j,k, rho, rho_e_orig/rho, state(i,j,k,UEINT)/rho
                     call bl_abort('negative rho e exiting strang')
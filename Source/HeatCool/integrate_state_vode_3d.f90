@@ -1,6 +1,7 @@
 subroutine integrate_state_vode(lo, hi, &
                                 state   , s_l1, s_l2, s_l3, s_h1, s_h2, s_h3, &
                                 diag_eos, d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                hc_cost , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
                                 a, half_dt, min_iter, max_iter)
 !
 !   Calculates the sources to be added later on.
@@ -15,6 +16,8 @@ subroutine integrate_state_vode(lo, hi, &
 !       The state vars
 !   diag_eos_* : double arrays
 !       Temp and Ne
+!   hc_cost_* : double arrays
+!       Incremented by the number of RHS evaluations and VODE steps per cell
 !   src_* : doubles arrays
 !       The source terms to be added to state (iterative approx.)
 !   double array (3)
@@ -44,12 +47,14 @@ subroutine integrate_state_vode(lo, hi, &
     integer         , intent(in) :: lo(3), hi(3)
     integer         , intent(in) :: s_l1, s_l2, s_l3, s_h1, s_h2, s_h3
     integer         , intent(in) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer         , intent(in) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
     real(rt), intent(inout) ::    state(s_l1:s_h1, s_l2:s_h2,s_l3:s_h3, NVAR)
     real(rt), intent(inout) :: diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(inout) ::  hc_cost(c_l1:c_h1, c_l2:c_h2,c_l3:c_h3, 2)
     real(rt), intent(in)    :: a, half_dt
     integer         , intent(inout) :: max_iter, min_iter
 
-    integer :: i, j, k
+    integer :: i, j, k, nsteps, nrhs
     real(rt) :: z, rho
     real(rt) :: T_orig, ne_orig, e_orig
     real(rt) :: T_out , ne_out , e_out
@@ -85,7 +90,10 @@ subroutine integrate_state_vode(lo, hi, &
                 k_vode = k
 
                 call vode_wrapper(half_dt,rho,T_orig,ne_orig,e_orig, &
-                                              T_out ,ne_out ,e_out)
+                                              T_out ,ne_out ,e_out, nsteps, nrhs)
+
+                hc_cost(i,j,k,1) = hc_cost(i,j,k,1) + nrhs
+                hc_cost(i,j,k,2) = hc_cost(i,j,k,2) + nsteps
 
                 if (e_out .lt. 0.d0) then
                     print *,'negative e entering strang integration ',i,j,k, e_out
@@ -107,8 +115,9 @@ subroutine integrate_state_vode(lo, hi, &
 
 end subroutine integrate_state_vode
 
-subroutine vode_wrapper(dt, rho_in, T_in, ne_in, e_in, T_out, ne_out, e_out)
+subroutine vode_wrapper(dt, rho_in, T_in, ne_in, e_in, T_out, ne_out, e_out, nsteps, nrhs)
 
+    use amrex_fort_module, only : rt => amrex_real
     use vode_aux_module, only: rho_vode, T_vode, ne_vode, &
                                i_vode, j_vode, k_vode
 
@@ -117,6 +126,7 @@ subroutine vode_wrapper(dt, rho_in, T_in, ne_in, e_in, T_out, ne_out, e_out)
     real(rt), intent(in   ) :: dt
     real(rt), intent(in   ) :: rho_in, T_in, ne_in, e_in
     real(rt), intent(  out) ::         T_out,ne_out,e_out
+    integer , intent(  out) :: nsteps, nrhs
 
     ! Set the number of independent variables -- this should be just "e"
     integer, parameter :: NEQ = 1
@@ -209,6 +219,11 @@ subroutine vode_wrapper(dt, rho_in, T_in, ne_in, e_in, T_out, ne_out, e_out)
     T_out  = T_vode
     ne_out = ne_vode
 
+    ! Number of steps taken, and number of RHS evaluations including the
+    ! NEQ extra ones needed for each finite-difference Jacobian
+    nsteps = iwork(11)
+    nrhs   = iwork(12) + NEQ*iwork(13)
+
     if (istate < 0) then
        print *, 'istate = ', istate, 'at (i,j,k) ',i_vode,j_vode,k_vode
        call bl_error("ERROR in vode_wrapper: integration failed")
@@ -0,0 +1,233 @@
+subroutine integrate_state_with_source(lo, hi, &
+                                       state_old, so_l1, so_l2, so_l3, so_h1, so_h2, so_h3, &
+                                       state_new, sn_l1, sn_l2, sn_l3, sn_h1, sn_h2, sn_h3, &
+                                       diag_eos , d_l1, d_l2, d_l3, d_h1, d_h2, d_h3, &
+                                       hc_cost  , c_l1, c_l2, c_l3, c_h1, c_h2, c_h3, &
+                                       a, dt, min_iter, max_iter) &
+                                       bind(C, name="integrate_state_with_source")
+!
+!   Simplified SDC coupling of heating/cooling to the hydro: the hydro update
+!   (state_new - state_old)/dt is held constant as a source of rho and (rho e)
+!   while (rho e) is integrated with VODE over the full dt from state_old.
+!
+!   Parameters
+!   ----------
+!   lo : double array (3)
+!       The low corner of the current box.
+!   hi : double array (3)
+!       The high corner of the current box.
+!   state_old_* : double arrays
+!       The state vars at the start of the step
+!   state_new_* : double arrays
+!       The state vars after the hydro update, without heating/cooling
+!   diag_eos_* : double arrays
+!       Temp and Ne
+!   hc_cost_* : double arrays
+!       Incremented by the number of RHS evaluations and VODE steps per cell
+!   a : double
+!       The a at the middle of the step
+!   dt : double
+!       time step size, in Mpc km^-1 s ~ 10^12 yr.
+!
+!   Returns
+!   -------
+!   state_new : double array (dims)
+!       (rho e) and (rho E) now include the heating/cooling over dt
+!
+    use amrex_fort_module, only : rt => amrex_real
+    use meth_params_module, only : NVAR, URHO, UEDEN, UEINT, &
+                                   TEMP_COMP, NE_COMP
+    use eos_module, only: nyx_eos_T_given_Re
+    use atomic_rates_module, only: interp_to_this_z
+    use vode_aux_module    , only: z_vode, i_vode, j_vode, k_vode
+
+    implicit none
+
+    integer         , intent(in) :: lo(3), hi(3)
+    integer         , intent(in) :: so_l1, so_l2, so_l3, so_h1, so_h2, so_h3
+    integer         , intent(in) :: sn_l1, sn_l2, sn_l3, sn_h1, sn_h2, sn_h3
+    integer         , intent(in) :: d_l1, d_l2, d_l3, d_h1, d_h2, d_h3
+    integer         , intent(in) :: c_l1, c_l2, c_l3, c_h1, c_h2, c_h3
+    real(rt), intent(in   ) :: state_old(so_l1:so_h1, so_l2:so_h2,so_l3:so_h3, NVAR)
+    real(rt), intent(inout) :: state_new(sn_l1:sn_h1, sn_l2:sn_h2,sn_l3:sn_h3, NVAR)
+    real(rt), intent(inout) ::  diag_eos(d_l1:d_h1, d_l2:d_h2,d_l3:d_h3, 2)
+    real(rt), intent(inout) ::   hc_cost(c_l1:c_h1, c_l2:c_h2,c_l3:c_h3, 2)
+    real(rt), intent(in)    :: a, dt
+    integer         , intent(inout) :: max_iter, min_iter
+
+    integer :: i, j, k, nsteps, nrhs
+    real(rt) :: z, rho_old, rho_new, rho_src, rhoe_old, rhoe_adv, rhoe_src
+    real(rt) :: T_out, ne_out, rhoe_out
+
+    z = 1.d0/a - 1.d0
+
+    z_vode = z
+
+    ! Interpolate from the table to this redshift
+    call interp_to_this_z(z)
+
+    do k = lo(3),hi(3)
+        do j = lo(2),hi(2)
+            do i = lo(1),hi(1)
+
+                rho_old  = state_old(i,j,k,URHO)
+                rhoe_old = state_old(i,j,k,UEINT)
+                rho_new  = state_new(i,j,k,URHO)
+                rhoe_adv = state_new(i,j,k,UEINT)
+
+                if (rhoe_old .lt. 0.d0) then
+                    print *,'negative rho e entering sdc integration ',i,j,k, rhoe_old
+                    call bl_abort('bad rho e in sdc')
+                end if
+
+                ! Hydro sources, constant over the step
+                rho_src  = (rho_new  - rho_old ) / dt
+                rhoe_src = (rhoe_adv - rhoe_old) / dt
+
+                i_vode = i
+                j_vode = j
+                k_vode = k
+
+                call vode_wrapper_with_source(dt, rho_old, rho_src, rhoe_src, &
+                                              diag_eos(i,j,k,TEMP_COMP), diag_eos(i,j,k,NE_COMP), &
+                                              rhoe_old, rhoe_out, nsteps, nrhs)
+
+                hc_cost(i,j,k,1) = hc_cost(i,j,k,1) + nrhs
+                hc_cost(i,j,k,2) = hc_cost(i,j,k,2) + nsteps
+
+                min_iter = min(min_iter, nsteps)
+                max_iter = max(max_iter, nsteps)
+
+                if (rhoe_out .lt. 0.d0) then
+                    print *,'negative rho e exiting sdc integration ',i,j,k, rhoe_out
+                    call bl_abort('bad rho e out of sdc')
+                end if
+
+                ! Replace the hydro-only (rho e) and adjust (rho E) by the same amount
+                state_new(i,j,k,UEINT) = rhoe_out
+                state_new(i,j,k,UEDEN) = state_new(i,j,k,UEDEN) + (rhoe_out - rhoe_adv)
+
+                ! Update T and ne (do not use stuff computed in f_rhs, per vode manual)
+                T_out  = diag_eos(i,j,k,TEMP_COMP)
+                ne_out = diag_eos(i,j,k,  NE_COMP)
+                call nyx_eos_T_given_Re(T_out, ne_out, rho_new, rhoe_out/rho_new, a)
+                diag_eos(i,j,k,TEMP_COMP) = T_out
+                diag_eos(i,j,k,  NE_COMP) = ne_out
+
+            end do ! i
+        end do ! j
+    end do ! k
+
+end subroutine integrate_state_with_source
+
+subroutine vode_wrapper_with_source(dt, rho_in, rho_src, rhoe_src, T_in, ne_in, &
+                                    rhoe_in, rhoe_out, nsteps, nrhs)
+
+    use amrex_fort_module, only : rt => amrex_real
+    use vode_aux_module, only: rho_vode, T_vode, ne_vode, &
+                               rho_init_vode, rho_src_vode, rhoe_src_vode, &
+                               i_vode, j_vode, k_vode
+
+    implicit none
+
+    real(rt), intent(in   ) :: dt
+    real(rt), intent(in   ) :: rho_in, rho_src, rhoe_src, T_in, ne_in, rhoe_in
+    real(rt), intent(  out) :: rhoe_out
+    integer , intent(  out) :: nsteps, nrhs
+
+    ! We integrate (rho e) only; rho follows from its constant source
+    integer, parameter :: NEQ = 1
+
+    real(rt) :: y(NEQ)
+
+    ! Stiff, with the jacobian computed by differencing
+    integer, parameter :: MF_NUMERICAL_JAC = 22
+
+    integer, parameter :: ITOL = 1
+    real(rt) :: atol(NEQ), rtol(NEQ)
+
+    integer, parameter :: ITASK = 1
+    integer :: istate
+
+    integer, parameter :: IOPT = 1
+
+    integer, parameter :: LRW = 22 + 9*NEQ + 2*NEQ**2
+    real(rt)   :: rwork(LRW)
+    real(rt)   :: time
+
+    integer, parameter :: LIW = 30 + NEQ
+    integer, dimension(LIW) :: iwork
+
+    real(rt) :: rpar
+    integer          :: ipar
+
+    EXTERNAL jac, f_rhs_with_source
+
+    T_vode   = T_in
+    ne_vode  = ne_in
+    rho_vode = rho_in
+
+    rho_init_vode = rho_in
+    rho_src_vode  = rho_src
+    rhoe_src_vode = rhoe_src
+
+    ! We want VODE to re-initialize each time we call it
+    istate = 1
+
+    rwork(:) = 0.d0
+    iwork(:) = 0
+
+    ! Set the maximum number of steps allowed (the VODE default is 500)
+    iwork(6) = 1000
+
+    time = 0.d0
+
+    y(1) = rhoe_in
+
+    atol(1) = 1.d-4 * rhoe_in
+    rtol(1) = 1.d-4
+
+    call dvode(f_rhs_with_source, NEQ, y, time, dt, ITOL, rtol, atol, ITASK, &
+               istate, IOPT, rwork, LRW, iwork, LIW, jac, MF_NUMERICAL_JAC, &
+               rpar, ipar)
+
+    rhoe_out = y(1)
+
+    ! Number of steps taken, and number of RHS evaluations including the
+    ! NEQ extra ones needed for each finite-difference Jacobian
+    nsteps = iwork(11)
+    nrhs   = iwork(12) + NEQ*iwork(13)
+
+    if (istate < 0) then
+       print *, 'istate = ', istate, 'at (i,j,k) ',i_vode,j_vode,k_vode
+       call bl_error("ERROR in vode_wrapper_with_source: integration failed")
+    endif
+
+end subroutine vode_wrapper_with_source
+
+subroutine f_rhs_with_source(num_eq, time, rhoe_in, rhoe_dot, rpar, ipar)
+
+    ! d(rho e)/dt = rho(t) de/dt|heat/cool + (rho e) hydro source,
+    ! with rho(t) = rho_init + t * rho_src
+
+    use amrex_fort_module, only : rt => amrex_real
+    use vode_aux_module, only: rho_vode, rho_init_vode, rho_src_vode, rhoe_src_vode
+
+    implicit none
+
+    integer , intent(in   ) :: num_eq, ipar
+    real(rt), intent(inout) :: rhoe_in(num_eq)
+    real(rt), intent(in   ) :: time
+    real(rt), intent(in   ) :: rpar
+    real(rt), intent(  out) :: rhoe_dot(num_eq)
+
+    real(rt) :: e(1), e_dot
+
+    rho_vode = rho_init_vode + time * rho_src_vode
+
+    e(1) = rhoe_in(1) / rho_vode
+    call f_rhs(1, time, e, e_dot, rpar, ipar)
+
+    rhoe_dot(1) = rho_vode * e_dot + rhoe_src_vode
+
+end subroutine f_rhs_with_source
@@ -11,4 +11,8 @@ module vode_aux_module
   integer , save :: i_vode, j_vode, k_vode
   !$OMP THREADPRIVATE (rho_vode, T_vode, ne_vode, i_vode, j_vode, k_vode)
 
+  ! Constant hydro sources for the simplified SDC integration
+  real(rt), save :: rho_init_vode, rho_src_vode, rhoe_src_vode
+  !$OMP THREADPRIVATE (rho_init_vode, rho_src_vode, rhoe_src_vode)
+
 end module vode_aux_module
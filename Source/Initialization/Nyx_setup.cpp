@@ -4,6 +4,7 @@
 #include "Nyx.H"
 #include "Nyx_F.H"
 #include "Derive_F.H"
+#include "uvb_table.H"
 
 using namespace amrex;
 using std::string;
@@ -20,6 +21,36 @@ static Box grow_box_by_one(const Box& b)
 
 typedef StateDescriptor::BndryFunc BndryFunc;
 
+//
+// Read the UV background on the I/O processor and broadcast it, so that
+// only one rank touches the file system.  Any table in TREECOOL format can
+// be given with nyx.uvb_file; see read_uvb_file for the layout.
+//
+void
+Nyx::read_uvb_table ()
+{
+    const int ncol   = 7;
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+
+    Array<Real> table;
+    int nrows = 0;
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        nrows = read_uvb_file(uvb_file, table);
+
+        if (verbose)
+            std::cout << "Read " << nrows << " UV background rates from " << uvb_file
+                      << " up to z = " << std::pow(10.0,table[ncol*(nrows-1)]) - 1.0 << '\n';
+    }
+
+    ParallelDescriptor::Bcast(&nrows, 1, IOProc);
+    table.resize(ncol*nrows);
+    ParallelDescriptor::Bcast(table.dataPtr(), table.size(), IOProc);
+
+    fort_set_uvb_table(&nrows, table.dataPtr());
+}
+
 //
 // Components are:
 //  Interior, Inflow, Outflow,  Symmetry,     SlipWall,     NoSlipWall
@@ -232,6 +263,12 @@ Nyx::hydro_setup()
          use_const_species, gamma, normalize_species,
          heat_cool_type, ParallelDescriptor::Communicator());
 
+    if (heat_cool_type == 1 || heat_cool_type == 3)
+    {
+        fort_tabulate_rates(&cooling_table_size);
+        read_uvb_table();
+    }
+
     if (use_const_species == 1)
         fort_set_eos_params(h_species, he_species);
 
@@ -272,6 +309,15 @@ Nyx::hydro_setup()
                            store_in_checkpoint);
 #endif
 
+#ifdef HEATCOOL
+    // Per-cell work estimate (hydro plus heating/cooling cost), rebuilt every step
+    store_in_checkpoint = false;
+    desc_lst.addDescriptor(Work_Estimate_Type, IndexType::TheCellType(),
+                           StateDescriptor::Point, 0, 1,
+                           &pc_interp, state_data_extrap,
+                           store_in_checkpoint);
+#endif
+
     Array<BCRec> bcs(NUM_STATE);
     Array<std::string> name(NUM_STATE);
 
@@ -392,6 +438,11 @@ Nyx::hydro_setup()
                              BndryFunc(generic_fill));
     }
 #endif
+#ifdef HEATCOOL
+    set_scalar_bc(bc, phys_bc);
+    desc_lst.setComponent(Work_Estimate_Type, 0, "work_estimate", bc,
+                          BndryFunc(generic_fill));
+#endif
 
     //
     // DEFINE DERIVED QUANTITIES
@@ -666,6 +717,12 @@ Nyx::no_hydro_setup()
          use_const_species, gamma, normalize_species,
          heat_cool_type, ParallelDescriptor::Communicator());
 
+    if (heat_cool_type == 1 || heat_cool_type == 3)
+    {
+        fort_tabulate_rates(&cooling_table_size);
+        read_uvb_table();
+    }
+
     int coord_type = Geometry::Coord();
     fort_set_problem_params(dm, phys_bc.lo(), phys_bc.hi(), Outflow, Symmetry, coord_type);
 
@@ -700,6 +757,18 @@ Nyx::no_hydro_setup()
     set_scalar_bc(bc, phys_bc);
     desc_lst.setComponent(DiagEOS_Type, 0, "Temp", bc,
                           BndryFunc(generic_fill));
+
+#ifdef HEATCOOL
+    store_in_checkpoint = false;
+    desc_lst.addDescriptor(Work_Estimate_Type, IndexType::TheCellType(),
+                           StateDescriptor::Point, 0, 1,
+                           &pc_interp, state_data_extrap,
+                           store_in_checkpoint);
+
+    set_scalar_bc(bc, phys_bc);
+    desc_lst.setComponent(Work_Estimate_Type, 0, "work_estimate", bc,
+                          BndryFunc(generic_fill));
+#endif
 #endif
 
     store_in_checkpoint = true;
@@ -57,4 +57,77 @@ contains
 
   end subroutine gs_rb_smoother_3d
 
+  !
+  ! One red/black sweep from a single exchange of a two-deep halo.  uu and
+  ! ff both carry ng >= 2 ghost cells, filled beforehand.  The red cells are
+  ! updated over rlo:rhi, which is lo:hi grown by one, where cm is nonzero:
+  ! on lo:hi and the ghost cells that some grid covers.  So the black cells
+  ! of lo:hi see the same red values the neighboring grids compute and no
+  ! exchange is needed between the colors, while ghost cells outside the
+  ! grids keep their boundary values.  The two colors are fused into one wavefront in k: black
+  ! plane k-1 only needs red planes k-2:k, so each plane is updated twice
+  ! while it is still in cache.
+  !
+  subroutine gs_rb_smoother_ca_3d(ss, uu, ff, cm, lo, hi, rlo, rhi, ng)
+    use bl_prof_module
+    integer, intent(in) :: ng
+    integer, intent(in) :: lo(:), hi(:), rlo(:), rhi(:)
+    real (rt), intent(in) :: ss(0:,lo(1):, lo(2):, lo(3):)
+    real (rt), intent(inout) :: uu(lo(1)-ng:,lo(2)-ng:,lo(3)-ng:)
+    real (rt), intent(in) :: ff(lo(1)-ng:,lo(2)-ng:,lo(3)-ng:)
+    real (rt), intent(in) :: cm(lo(1)-ng:,lo(2)-ng:,lo(3)-ng:)
+    integer :: i, j, k, kk, ioff
+    real(rt) :: dd, dhsq_inv, ss0_inv
+
+    type(bl_prof_timer), save :: bpt
+
+    call build(bpt, "gs_rb_smoother_ca_3d")
+
+    ss0_inv  =  1.d0/ss(0,lo(1),lo(2),lo(3))
+    dhsq_inv = -ss(0,lo(1),lo(2),lo(3))/6.d0
+
+    !$OMP PARALLEL PRIVATE(kk,k,j,i,ioff,dd) IF((hi(3)-lo(3)).ge.3)
+    do kk = rlo(3), rhi(3)+1
+
+       ! Red (i+j+k even) in plane kk of the grown region
+       if (kk .le. rhi(3)) then
+          !$OMP DO
+          do j = rlo(2), rhi(2)
+             ioff = modulo(rlo(1) + j + kk, 2)
+             do i = rlo(1)+ioff, rhi(1), 2
+                if (cm(i,j,kk) .eq. 0.d0) cycle
+                dd = (-6.d0*uu(i,j,kk)   + &
+                      uu(i+1,j,kk) + uu(i-1,j,kk) + &
+                      uu(i,j+1,kk) + uu(i,j-1,kk) + &
+                      uu(i,j,kk+1) + uu(i,j,kk-1) ) * dhsq_inv
+                uu(i,j,kk) = uu(i,j,kk) + (ff(i,j,kk) - dd)*ss0_inv
+             end do
+          end do
+          !$OMP END DO
+       end if
+
+       ! Black (i+j+k odd) in plane kk-1 of the valid region
+       k = kk - 1
+       if (k .ge. lo(3) .and. k .le. hi(3)) then
+          !$OMP DO
+          do j = lo(2), hi(2)
+             ioff = 1 - modulo(lo(1) + j + k, 2)
+             do i = lo(1)+ioff, hi(1), 2
+                dd = (-6.d0*uu(i,j,k)   + &
+                      uu(i+1,j,k) + uu(i-1,j,k) + &
+                      uu(i,j+1,k) + uu(i,j-1,k) + &
+                      uu(i,j,k+1) + uu(i,j,k-1) ) * dhsq_inv
+                uu(i,j,k) = uu(i,j,k) + (ff(i,j,k) - dd)*ss0_inv
+             end do
+          end do
+          !$OMP END DO
+       end if
+
+    end do
+    !$OMP END PARALLEL
+
+    call destroy(bpt)
+
+  end subroutine gs_rb_smoother_ca_3d
+
 end module cc_smoothers_module
@@ -13,7 +13,7 @@ contains
   subroutine mg_tower_smoother(mgt, lev, ss, uu, ff, mm)
 
     use bl_prof_module
-    use cc_smoothers_module, only: gs_rb_smoother_3d
+    use cc_smoothers_module, only: gs_rb_smoother_3d, gs_rb_smoother_ca_3d
 
     integer        , intent(in   ) :: lev
     type( mg_tower), intent(inout) :: mgt
@@ -25,9 +25,12 @@ contains
     real(rt), pointer :: fp(:,:,:,:)
     real(rt), pointer :: up(:,:,:,:)
     real(rt), pointer :: sp(:,:,:,:)
+    real(rt), pointer :: wp(:,:,:,:)
     integer        , pointer :: mp(:,:,:,:)
     integer :: i, k, n, ng, nn, stat, npts
-    integer :: lo(mgt%dim)
+    integer :: lo(mgt%dim), hi(mgt%dim), rlo(mgt%dim), rhi(mgt%dim)
+    integer :: pdlo(mgt%dim), pdhi(mgt%dim)
+    type(multifab) :: uf
     type(bl_prof_timer), save :: bpt
     logical :: pmask(mgt%dim), singular_test
     real(rt) :: local_eps
@@ -51,21 +54,64 @@ contains
        mgt%skewed_not_set(lev) = .false.
     end if
 
-    do nn = 0, 1
-       call multifab_fill_boundary(uu, cross = mgt%lcross)
+    if (lev .eq. mgt%nlevels) then
+
+       ! The finest level is bandwidth bound: smooth in place, with an
+       ! exchange of the one-deep halo before each color
+       do nn = 0, 1
+          call multifab_fill_boundary(uu, cross = mgt%lcross)
+
+          do i = 1, nfabs(ff)
+             up => dataptr(uu, i)
+             fp => dataptr(ff, i)
+             sp => dataptr(ss, i)
+             mp => dataptr(mm, i)
+             lo =  lwb(get_box(ss, i))
+             call gs_rb_smoother_3d(mgt%omega, sp(:,:,:,:), up(:,:,:,1), &
+                                    fp(:,:,:,1), mp(:,:,:,1), lo, ng, nn, &
+                                    mgt%skewed(lev,i))
+          end do
+
+       end do
+
+    else
+
+       ! The coarser levels are latency bound: exchange u and f together,
+       ! two deep, once, and do both colors locally.  Boundary values of u
+       ! outside the grids come with the copy of uu.  The third component is
+       ! 1 on the grids, so after the exchange it is 1 on exactly the ghost
+       ! cells some grid covers, the only ones the red sweep may update.
+       call multifab_build(uf, get_layout(uu), 3, 2)
+       call setval(uf, 0.0_rt, all = .true.)
+       call setval(uf, 1.0_rt, 3, 1, all = .false.)
+       call multifab_copy_c(uf, 1, uu, 1, 1, ng)
+       call multifab_copy_c(uf, 2, ff, 1, 1)
+       call multifab_fill_boundary(uf)
+
+       pdlo = lwb(mgt%pd(lev))
+       pdhi = upb(mgt%pd(lev))
 
        do i = 1, nfabs(ff)
-          up => dataptr(uu, i)
-          fp => dataptr(ff, i)
+          wp => dataptr(uf, i)
           sp => dataptr(ss, i)
-          mp => dataptr(mm, i)
           lo =  lwb(get_box(ss, i))
-          call gs_rb_smoother_3d(mgt%omega, sp(:,:,:,:), up(:,:,:,1), &
-                                 fp(:,:,:,1), mp(:,:,:,1), lo, ng, nn, &
-                                 mgt%skewed(lev,i))
+          hi =  upb(get_box(ss, i))
+          do k = 1, mgt%dim
+             rlo(k) = lo(k) - 1
+             rhi(k) = hi(k) + 1
+             if (.not. pmask(k)) then
+                rlo(k) = max(rlo(k), pdlo(k))
+                rhi(k) = min(rhi(k), pdhi(k))
+             end if
+          end do
+          call gs_rb_smoother_ca_3d(sp(:,:,:,:), wp(:,:,:,1), wp(:,:,:,2), wp(:,:,:,3), &
+                                    lo, hi, rlo, rhi, 2)
        end do
 
-    end do
+       call multifab_copy_c(uu, 1, uf, 1, 1)
+       call multifab_destroy(uf)
+
+    end if
 
     call destroy(bpt)
 
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+
 #include "NyxParticleContainer.H"
 
 using namespace amrex;
@@ -1031,119 +1034,251 @@ NeutrinoParticleContainer::AssignRelativisticDensitySingleLevel (MultiFab& mf_to
     if (mf_pointer->nGrow() < 1) 
        amrex::Error("Must have at least one ghost cell when in AssignDensitySingleLevel");
 
-    const Real      strttime    = ParallelDescriptor::second();
-    const Geometry& gm          = m_gdb->Geom(lev);
+    const Real strttime = ParallelDescriptor::second();
+
+    DepositRelativisticDensity(*mf_pointer, lev, m_gdb->Geom(lev),
+                               m_gdb->Geom(lev + particle_lvl_offset).CellSize(), ncomp);
+
+    // If mf_to_be_filled is not defined on the particle_box_array, then we need
+    // to copy here from mf_pointer into mf_to_be_filled.   I believe that we don't
+    // need any information in ghost cells so we don't copy those.
+    if (mf_pointer != &mf_to_be_filled)
+    {
+        mf_to_be_filled.copy(*mf_pointer,0,0,ncomp);
+	delete mf_pointer;
+    }
+
+    if (m_verbose > 1)
+    {
+        Real stoptime = ParallelDescriptor::second() - strttime;
+
+        ParallelDescriptor::ReduceRealMax(stoptime,ParallelDescriptor::IOProcessorNumber());
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            std::cout << "NeutrinoParticleContainer<N>::AssignRelativisticDensitySingleLevel time: " << stoptime << '\n';
+        }
+    }
+}
+
+void
+NeutrinoParticleContainer::AssignRelativisticDensityCoarse (MultiFab&       crse,
+                                                            const Geometry& cgeom,
+                                                            int             lev) const
+{
+    BL_PROFILE("NeutrinoParticleContainer::AssignRelativisticDensityCoarse()");
+
+    if (crse.size() != m_gdb->ParticleBoxArray(lev).size() ||
+        crse.DistributionMap() != m_gdb->ParticleDistributionMap(lev))
+        amrex::Error("AssignRelativisticDensityCoarse: crse must be on the coarsened particle grids");
+
+    if (crse.nGrow() < 1)
+        amrex::Error("Must have at least one ghost cell when in AssignRelativisticDensityCoarse");
+
+    DepositRelativisticDensity(crse, lev, cgeom, cgeom.CellSize(), 1);
+}
+
+//
+// CIC deposit of the particles at lev onto mf, whose grids are those of
+// the particles at lev or coarsenings of them, with cells of gm.
+//
+void
+NeutrinoParticleContainer::DepositRelativisticDensity (MultiFab&       mf,
+                                                       int             lev,
+                                                       const Geometry& gm,
+                                                       const Real*     dx_particle,
+                                                       int             ncomp) const
+{
     const Real*     plo         = gm.ProbLo();
-    const Real*     dx_particle = m_gdb->Geom(lev + particle_lvl_offset).CellSize();
     const Real*     dx          = gm.CellSize();
     const PMap&     pmap        = m_particles[lev];
-    const int       ngrids      = pmap.size();
 
     if (gm.isAnyPeriodic() && ! gm.isAllPeriodic()) {
         amrex::Error("AssignDensity: problem must be periodic in no or all directions");
     }
 
-    for (MFIter mfi(*mf_pointer); mfi.isValid(); ++mfi) {
-        (*mf_pointer)[mfi].setVal(0);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        mf[mfi].setVal(0);
     }
+
     //
-    // This is a little funky.  What in effect this'll do is force
-    // each thread to work on a single (separate) grid at a time.  That
-    // way no thread will step on any other.  If there's only one grid per CPU,
-    // then oh well ....
+    // The particles of each grid are bucketed by the tile of the grid their
+    // cell falls in.  Each tile is deposited into a FAB covering only the
+    // tile and the cells its particles' clouds reach, and those small FABs
+    // are added into the grid's FAB one at a time.
     //
-    // TODO: implement tiling with OpenMP in this grid loop.
-    Array<int>         pgrd(ngrids);
-    Array<const PBox*> pbxs(ngrids);
+    IntVect ng;
+    for (int d = 0; d < BL_SPACEDIM; d++)
+        ng[d] = 1 + static_cast<int>(dx_particle[d] / dx[d]);
+
+    const IntVect& tsize = FabArrayBase::mfiter_tile_size;
+
+    Array<const PBox*> tile_pbx;
+    Array<int>         tile_grid;
+    Array<Box>         tile_box;
+    Array<int>         tile_lo, tile_hi;
+    Array<int>         order;
 
-    int j = 0;
     for (typename PMap::const_iterator pmap_it = pmap.begin(), pmapEnd = pmap.end();
          pmap_it != pmapEnd;
-         ++pmap_it, ++j)
+         ++pmap_it)
     {
-        pgrd[j] =   pmap_it->first;
-        pbxs[j] = &(pmap_it->second);
+        const int   grid = pmap_it->first;
+        const PBox& pbx  = pmap_it->second;
+        const int   np   = pbx.size();
+        const Box&  vbx  = mf.boxArray()[grid];
+
+        IntVect nt;
+        int     ntg = 1;
+        for (int d = 0; d < BL_SPACEDIM; d++)
+        {
+            nt[d] = (vbx.length(d) + tsize[d] - 1) / tsize[d];
+            ntg  *= nt[d];
+        }
+
+        Array<int> which(np, -1);
+        Array<int> start(ntg+1, 0);
+
+        for (int ip = 0; ip < np; ip++)
+        {
+            const ParticleType& p = pbx[ip];
+
+            if (p.m_id <= 0) {
+              continue;
+            }
+
+            int t = 0, stride = 1;
+            for (int d = 0; d < BL_SPACEDIM; d++)
+            {
+                int c = static_cast<int>(std::floor((p.m_pos[d] - plo[d]) / dx[d]));
+                c = std::min(std::max(c, vbx.smallEnd(d)), vbx.bigEnd(d));
+                t      += (c - vbx.smallEnd(d)) / tsize[d] * stride;
+                stride *= nt[d];
+            }
+            which[ip] = t;
+            start[t+1]++;
+        }
+
+        for (int t = 0; t < ntg; t++)
+            start[t+1] += start[t];
+
+        const int base = order.size();
+        order.resize(base + start[ntg]);
+
+        Array<int> next(start.begin(), start.end()-1);
+        for (int ip = 0; ip < np; ip++)
+            if (which[ip] >= 0)
+                order[base + next[which[ip]]++] = ip;
+
+        for (int t = 0; t < ntg; t++)
+        {
+            if (start[t+1] == start[t]) continue;
+
+            IntVect lo, hi;
+            for (int d = 0, r = t; d < BL_SPACEDIM; d++)
+            {
+                lo[d] = vbx.smallEnd(d) + (r % nt[d]) * tsize[d];
+                hi[d] = std::min(lo[d] + tsize[d] - 1, vbx.bigEnd(d));
+                r    /= nt[d];
+            }
+
+            tile_pbx.push_back(&pbx);
+            tile_grid.push_back(grid);
+            tile_box.push_back(Box(lo, hi));
+            tile_lo.push_back(base + start[t]);
+            tile_hi.push_back(base + start[t+1]);
+        }
     }
 
-    for (int j = 0; j < ngrids; j++)
-    {
-        const PBox& pbx = *pbxs[j];
-        FArrayBox&  fab = (*mf_pointer)[pgrd[j]];
+    const int ntiles = tile_grid.size();
 
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
         Array<Real>    fracs;
         Array<IntVect> cells;
+        FArrayBox      local;
 
 #ifdef _OPENMP
-#pragma omp parallel for default(none) private(fracs,cells) shared(plo,dx,dx_particle,gm,fab,ncomp,pbx)
+#pragma omp for schedule(dynamic)
 #endif
-        for (typename PBox::const_iterator it = pbx.begin(); it < pbx.end(); ++it)
+        for (int t = 0; t < ntiles; t++)
         {
-            const ParticleType& p = *it;
-
-            if (p.m_id <= 0) {
-	      continue;
-	    }
+            const PBox& pbx = *tile_pbx[t];
+            FArrayBox&  fab = mf[tile_grid[t]];
+            const Box   bx  = amrex::grow(tile_box[t], ng) & fab.box();
 
-            const int M = ParticleBase::CIC_Cells_Fracs(p, plo, dx, dx_particle, fracs, cells);
-            //
-            // If this is not fully periodic then we have to be careful that the
-            // particle's support leaves the domain unless we specifically want to ignore
-            // any contribution outside the boundary (i.e. if allow_particles_near_boundary = true). 
-            // We test this by checking the low and high corners respectively.
-            //
-            if ( ! gm.isAllPeriodic() && ! allow_particles_near_boundary) {
-                if ( ! gm.Domain().contains(cells[0]) || ! gm.Domain().contains(cells[M-1])) {
-                    amrex::Error("AssignDensity: if not periodic, all particles must stay away from the domain boundary");
-		}
-	    }
+            local.resize(bx, ncomp);
+            local.setVal(0);
 
-            for (int i = 0; i < M; i++)
+            for (int k = tile_lo[t]; k < tile_hi[t]; k++)
             {
-                if ( ! fab.box().contains(cells[i])) {
-		  continue;
-		}
+                const ParticleType& p = pbx[order[k]];
 
-                // If the domain is not periodic and we want to let particles
-                //    live near the boundary but "throw away" the contribution that 
-                //    does not fall into the domain ...
-                if ( ! gm.isAllPeriodic() && allow_particles_near_boundary && ! gm.Domain().contains(cells[i])) {
-		  continue;
-		}
+                const int M = ParticleBase::CIC_Cells_Fracs(p, plo, dx, dx_particle, fracs, cells);
                 //
-                // Sum up mass in first component.
+                // If this is not fully periodic then we have to be careful that the
+                // particle's support leaves the domain unless we specifically want to ignore
+                // any contribution outside the boundary (i.e. if allow_particles_near_boundary = true). 
+                // We test this by checking the low and high corners respectively.
                 //
+                if ( ! gm.isAllPeriodic() && ! allow_particles_near_boundary) {
+                    if ( ! gm.Domain().contains(cells[0]) || ! gm.Domain().contains(cells[M-1])) {
+                        amrex::Error("AssignDensity: if not periodic, all particles must stay away from the domain boundary");
+                    }
+                }
+
+                Real gamma = 1.0;
+
                 if (m_relativistic)
                 {
                     Real vsq = 0.0;
                     for (int n = 1; n < ncomp; n++) {
                        vsq += p.m_data[n] * p.m_data[n];
-		    }
-                    Real gamma = 1.0 / sqrt(1.0 - vsq / m_csq);
-#ifdef _OPENMP
-#pragma omp atomic
-#endif
-                    fab(cells[i],0) += p.m_data[0] * fracs[i] * gamma;
+                    }
+                    gamma = 1.0 / sqrt(1.0 - vsq / m_csq);
                 }
-                else 
+
+                for (int i = 0; i < M; i++)
                 {
-#ifdef _OPENMP
-#pragma omp atomic
-#endif
-                    fab(cells[i],0) += p.m_data[0] * fracs[i];
+                    if ( ! local.box().contains(cells[i])) {
+                      continue;
+                    }
+
+                    // If the domain is not periodic and we want to let particles
+                    //    live near the boundary but "throw away" the contribution that 
+                    //    does not fall into the domain ...
+                    if ( ! gm.isAllPeriodic() && allow_particles_near_boundary && ! gm.Domain().contains(cells[i])) {
+                      continue;
+                    }
+                    //
+                    // Sum up mass in first component.
+                    //
+                    if (m_relativistic)
+                    {
+                        local(cells[i],0) += p.m_data[0] * fracs[i] * gamma;
+                    }
+                    else 
+                    {
+                        local(cells[i],0) += p.m_data[0] * fracs[i];
+                    }
+                    // 
+                    // Sum up momenta in next components.
+                    //
+                    for (int n = 1; n < ncomp; n++)
+                       local(cells[i],n) += p.m_data[n] * p.m_data[0] * fracs[i];
                 }
-                // 
-                // Sum up momenta in next components.
-                //
-                for (int n = 1; n < ncomp; n++)
+            }
+
 #ifdef _OPENMP
-#pragma omp atomic
+#pragma omp critical(neutrino_deposit_lock)
 #endif
-                   fab(cells[i],n) += p.m_data[n] * p.m_data[0] * fracs[i];
-            }
+            fab.plus(local, bx, 0, 0, ncomp);
         }
     }
 
-    mf_pointer->SumBoundary(gm.periodicity());
+    mf.SumBoundary(gm.periodicity());
     //
     // If ncomp > 1, first divide the momenta (component n) 
     // by the mass (component 0) in order to get velocities.
@@ -1151,9 +1286,9 @@ NeutrinoParticleContainer::AssignRelativisticDensitySingleLevel (MultiFab& mf_to
     //
     for (int n = 1; n < ncomp; n++)
     {
-        for (MFIter mfi(*mf_pointer); mfi.isValid(); ++mfi)
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
         {
-            (*mf_pointer)[mfi].protected_divide((*mf_pointer)[mfi],0,n,1);
+            mf[mfi].protected_divide(mf[mfi],0,n,1);
         }
     }
     //
@@ -1163,28 +1298,7 @@ NeutrinoParticleContainer::AssignRelativisticDensitySingleLevel (MultiFab& mf_to
     //
     const Real vol = D_TERM(dx[0], *dx[1], *dx[2]);
 
-    mf_pointer->mult(1/vol,0,1);
-
-    // If mf_to_be_filled is not defined on the particle_box_array, then we need
-    // to copy here from mf_pointer into mf_to_be_filled.   I believe that we don't
-    // need any information in ghost cells so we don't copy those.
-    if (mf_pointer != &mf_to_be_filled)
-    {
-        mf_to_be_filled.copy(*mf_pointer,0,0,ncomp);
-	delete mf_pointer;
-    }
-
-    if (m_verbose > 1)
-    {
-        Real stoptime = ParallelDescriptor::second() - strttime;
-
-        ParallelDescriptor::ReduceRealMax(stoptime,ParallelDescriptor::IOProcessorNumber());
-
-        if (ParallelDescriptor::IOProcessor())
-        {
-            std::cout << "NeutrinoParticleContainer<N>::AssignRelativisticDensitySingleLevel time: " << stoptime << '\n';
-        }
-    }
+    mf.mult(1/vol,0,1);
 }
 #endif
 
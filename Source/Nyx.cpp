@@ -107,7 +107,10 @@ Real Nyx::gamma      =  0;
 int Nyx::do_hydro = -1;
 int Nyx::add_ext_src = 0;
 int Nyx::heat_cool_type = 0;
+int Nyx::cooling_table_size = 2000;
+std::string Nyx::uvb_file = "TREECOOL_middle";
 int Nyx::strang_split = 0;
+int Nyx::sdc_split = 0;
 
 Real Nyx::average_gas_density = 0;
 Real Nyx::average_dm_density = 0;
@@ -301,8 +304,11 @@ Nyx::read_params ()
 
     pp.query("add_ext_src", add_ext_src);
     pp.query("strang_split", strang_split);
+    pp.query("sdc_split", sdc_split);
 
     pp.query("heat_cool_type", heat_cool_type);
+    pp.query("cooling_table_size", cooling_table_size);
+    pp.query("uvb_file", uvb_file);
 
     pp.query("use_exact_gravity", use_exact_gravity);
 
@@ -313,6 +319,12 @@ Nyx::read_params ()
        amrex::Error("Nyx:: nonzero heat_cool_type must equal 1 or 3");
     if (heat_cool_type == 0)
        amrex::Error("Nyx::contradiction -- HEATCOOL is defined but heat_cool_type == 0");
+    if (cooling_table_size < 2)
+       amrex::Error("Nyx::cooling_table_size must be at least 2");
+    if (sdc_split == 1 && strang_split == 1)
+       amrex::Error("Nyx::cannot set both strang_split and sdc_split");
+    if (sdc_split == 1 && heat_cool_type != 3)
+       amrex::Error("Nyx::sdc_split requires heat_cool_type == 3");
 #else
     if (heat_cool_type > 0)
        amrex::Error("Nyx::you set heat_cool_type > 0 but forgot to set USE_HEATCOOL = TRUE");
@@ -477,6 +489,13 @@ Nyx::Nyx (Amr&            papa,
 
     // Set grav_n_grow to 3 on init. It'll be reset in advance.
     grav_n_grow = 3;
+
+#ifndef NO_HYDRO
+#ifdef HEATCOOL
+    // Weight every cell equally until the first heating/cooling step
+    get_new_data(Work_Estimate_Type).setVal(1.0);
+#endif
+#endif
 }
 
 Nyx::~Nyx ()
@@ -530,6 +549,13 @@ Nyx::restart (Amr&     papa,
         gravity = new Gravity(parent, parent->finestLevel(), &phys_bc, Density);
     }
 #endif
+
+#ifndef NO_HYDRO
+#ifdef HEATCOOL
+    // The work estimate is not checkpointed
+    get_new_data(Work_Estimate_Type).setVal(1.0);
+#endif
+#endif
 }
 
 void
@@ -537,6 +563,17 @@ Nyx::build_metrics ()
 {
 }
 
+int
+Nyx::WorkEstType ()
+{
+#ifndef NO_HYDRO
+#ifdef HEATCOOL
+    return Work_Estimate_Type;
+#endif
+#endif
+    return -1;
+}
+
 void
 Nyx::setTimeLevel (Real time,
                    Real dt_old,
@@ -1101,6 +1138,43 @@ Nyx::do_energy_diagnostics ()
     // nothing to see here, folks
 }
 
+#ifdef GRAVITY
+//
+// For each active particle container and level up to finest_level, the
+// number of particles there over all ranks and the XOR of their hashes,
+// which changes if any particle moves to another level.
+//
+static
+void
+particle_level_signature (int                   finest_level,
+                          Array<long>&          counts,
+                          Array<unsigned long>& hashes)
+{
+    counts.clear();
+    hashes.clear();
+
+    for (int i = 0; i < Nyx::theActiveParticles().size(); i++)
+        for (int lev = 0; lev <= finest_level; lev++)
+        {
+            long          n;
+            unsigned long h;
+            Nyx::theActiveParticles()[i]->LocalLevelSignature(lev, n, h);
+            counts.push_back(n);
+            hashes.push_back(h);
+        }
+
+    if (counts.empty())
+        return;
+
+    ParallelDescriptor::ReduceLongSum(counts.dataPtr(), counts.size());
+#if BL_USE_MPI
+    BL_MPI_REQUIRE( MPI_Allreduce(MPI_IN_PLACE, hashes.dataPtr(), hashes.size(),
+                                  MPI_UNSIGNED_LONG, MPI_BXOR,
+                                  ParallelDescriptor::Communicator()) );
+#endif
+}
+#endif
+
 void
 Nyx::post_timestep (int iteration)
 {
@@ -1128,15 +1202,43 @@ Nyx::post_timestep (int iteration)
     //
     if (iteration < ncycle || level == 0)
     {
+#ifdef GRAVITY
+         // Particles changing level (or leaving the domain) change the
+         // density, so the new phi could no longer stand in for the next old
+         // phi.  Which particles each level holds is compared before and after.
+         const bool check_levels = do_grav && level == 0 && gravity->get_reuse_old_phi();
+         Array<long>          count_before;
+         Array<unsigned long> hash_before;
+         if (check_levels)
+             particle_level_signature(finest_level, count_before, hash_before);
+#endif
+
          for (int i = 0; i < theActiveParticles().size(); i++)
          {
              theActiveParticles()[i]->Redistribute(level,
                                                    theActiveParticles()[i]->finestLevel(),
                                                    grav_n_grow);
          }
+
+#ifdef GRAVITY
+         if (check_levels)
+         {
+             Array<long>          count_after;
+             Array<unsigned long> hash_after;
+             particle_level_signature(finest_level, count_after, hash_after);
+             if (count_after != count_before || hash_after != hash_before)
+                 gravity->mark_phi_new_stale();
+         }
+#endif
     }
 
 #ifndef NO_HYDRO
+#ifdef GRAVITY
+    // Without the gravity_sync below nothing corrects phi for average_down
+    if (do_grav && !do_reflux && level < finest_level)
+        gravity->mark_phi_new_stale();
+#endif
+
     if (do_reflux && level < finest_level)
     {
         MultiFab& S_new_crse = get_new_data(State_Type);
@@ -1412,6 +1514,9 @@ Nyx::postCoarseTimeStep (Real cumtime)
 
 #ifdef AGN
    halo_find();
+#ifdef GRAVITY
+   gravity->mark_phi_new_stale();
+#endif
 #endif 
 
 #ifdef GIMLET
@@ -1422,7 +1527,20 @@ Nyx::postCoarseTimeStep (Real cumtime)
     // postCoarseTimeStep() is only called by level 0.
     //
     if (Nyx::theDMPC() && particle_move_type == "Random")
+    {
         particle_move_random();
+#ifdef GRAVITY
+        gravity->mark_phi_new_stale();
+#endif
+    }
+
+#ifdef GRAVITY
+    if (Nyx::theDMPC() && do_grav && direct_force_check_int > 0 &&
+        parent->levelSteps(0) % direct_force_check_int == 0)
+    {
+        check_direct_forces(cur_time);
+    }
+#endif
 }
 
 void
@@ -1438,6 +1556,8 @@ Nyx::post_regrid (int lbase,
 
     if (level == lbase) {
         particle_redistribute(lbase, forceParticleRedist);
+        if (persistent_ghost_particles)
+            reset_ghost_particles(lbase);
     }
 
     int which_level_being_advanced = parent->level_being_advanced();
@@ -2160,10 +2280,15 @@ Nyx::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
         allInts.push_back(add_ext_src);
         allInts.push_back(heat_cool_type);
         allInts.push_back(strang_split);
+        allInts.push_back(sdc_split);
         allInts.push_back(reeber_int);
         allInts.push_back(gimlet_int);
         allInts.push_back(grav_n_grow);
         allInts.push_back(forceParticleRedist);
+        allInts.push_back(direct_force_check_int);
+        allInts.push_back(aggregate_virtual_particles);
+        allInts.push_back(persistent_ghost_particles);
+        allInts.push_back(particle_max_rung);
       }
 
       amrex::BroadcastArray(allInts, scsMyId, ioProcNumAll, scsComm);
@@ -2218,10 +2343,15 @@ Nyx::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
         add_ext_src = allInts[count++];
         heat_cool_type = allInts[count++];
         strang_split = allInts[count++];
+        sdc_split = allInts[count++];
         reeber_int = allInts[count++];
         gimlet_int = allInts[count++];
         grav_n_grow = allInts[count++];
         forceParticleRedist = allInts[count++];
+        direct_force_check_int = allInts[count++];
+        aggregate_virtual_particles = allInts[count++];
+        persistent_ghost_particles = allInts[count++];
+        particle_max_rung = allInts[count++];
 
         BL_ASSERT(count == allInts.size());
       }
@@ -2256,6 +2386,7 @@ Nyx::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
         allReals.push_back(average_dm_density);
         allReals.push_back(average_neutr_density);
         allReals.push_back(average_total_density);
+        allReals.push_back(direct_eps);
 #ifdef NEUTRINO_PARTICLES
         allReals.push_back(neutrino_cfl);
 #endif
@@ -2290,6 +2421,7 @@ Nyx::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
         average_dm_density = allReals[count++];
         average_neutr_density = allReals[count++];
         average_total_density = allReals[count++];
+        direct_eps = allReals[count++];
 #ifdef NEUTRINO_PARTICLES
         neutrino_cfl = allReals[count++];
 #endif
@@ -2304,6 +2436,7 @@ Nyx::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
         allStrings.push_back(particle_plotfile_format);
         allStrings.push_back(particle_init_type);
         allStrings.push_back(particle_move_type);
+        allStrings.push_back(uvb_file);
 
         serialStrings = amrex::SerializeStringArray(allStrings);
       }
@@ -2318,6 +2451,7 @@ Nyx::AddProcsToComp(Amr *aptr, int nSidecarProcs, int prevSidecarProcs,
         particle_plotfile_format = allStrings[count++];
         particle_init_type = allStrings[count++];
         particle_move_type = allStrings[count++];
+        uvb_file = allStrings[count++];
       }
 
 
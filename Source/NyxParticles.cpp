@@ -1,4 +1,5 @@
 #include <iomanip>
+#include <unordered_set>
 #include <Nyx.H>
 
 #ifdef GRAVITY
@@ -19,6 +20,12 @@ namespace
     std::string binary_particle_file;
     std::string    sph_particle_file;
 
+    //
+    // Number of ranks that read binary particle files, each its own range
+    // of records: 0 for the serial reader, -1 for all the ranks.
+    //
+    int binary_particle_readers = 0;
+
 #ifdef AGN
     std::string agn_particle_file;
 #endif
@@ -87,6 +94,16 @@ namespace
 #ifdef NEUTRINO_PARTICLES
     NeutrinoParticleContainer*   GhostNPC = 0;
 #endif
+    //
+    // The dark matter particles at each level with persistent ghosts at the
+    // next one, by (cpu, id)
+    //
+    Array<std::unordered_set<long> > ghosted_particles;
+    //
+    // The coarse step at which each level's persistent ghosts were last
+    // copied afresh from their parents
+    //
+    Array<int> ghosts_synced_at;
 
     void RemoveParticlesOnExit ()
     {
@@ -113,6 +130,12 @@ bool Nyx::do_dm_particles = false;
 std::string Nyx::particle_init_type = "";
 std::string Nyx::particle_move_type = "";
 
+Real Nyx::direct_eps             = 0;
+int  Nyx::direct_force_check_int = 0;
+
+int  Nyx::aggregate_virtual_particles = 0;
+int  Nyx::persistent_ghost_particles  = 0;
+
 // Allows us to output particles in the plotfile
 //   in either single (IEEE32) or double (NATIVE) precision.  
 // Particles are always written in double precision
@@ -129,6 +152,7 @@ int Nyx::write_particles_in_plotfile    = 1;
 int Nyx::write_particle_density_at_init = 0;
 int Nyx::write_coarsened_particles      = 0;
 Real Nyx::particle_cfl = 0.5;
+int  Nyx::particle_max_rung = 0;
 #ifdef NEUTRINO_PARTICLES
 Real Nyx::neutrino_cfl = 0.5;
 #endif
@@ -240,8 +264,22 @@ Nyx::read_particle_params ()
     }
 #endif
 
+    // Softening of the direct summation forces, used with particle_move_type =
+    // Direct and by the comparison with the mesh forces every direct_force_check_int
+    // coarse steps
+    pp.query("direct_eps", direct_eps);
+    pp.query("direct_force_check_int", direct_force_check_int);
+
+    pp.query("aggregate_virtual_particles", aggregate_virtual_particles);
+    pp.query("persistent_ghost_particles", persistent_ghost_particles);
+
+#ifdef AGN
+    if (particle_move_type == "Direct")
+        amrex::Error("particle_move_type = Direct only moves the dark matter, not the AGN particles");
+#endif
+
 #ifdef GRAVITY
-    if (!do_grav && particle_move_type == "Gravitational")
+    if (!do_grav && (particle_move_type == "Gravitational" || particle_move_type == "Direct"))
     {
         if (ParallelDescriptor::IOProcessor())
             std::cerr << "ERROR:: doesnt make sense to have do_grav=false but move_type = Gravitational" << std::endl;
@@ -294,6 +332,16 @@ Nyx::read_particle_params ()
         amrex::Error();
     }
 
+    pp.query("binary_particle_readers", binary_particle_readers);
+
+    // Input error check
+    if (binary_particle_readers < -1 || binary_particle_readers > ParallelDescriptor::NProcs())
+    {
+        if (ParallelDescriptor::IOProcessor())
+            std::cerr << "ERROR::binary_particle_readers must be -1 (all ranks), 0 (serial) or at most the number of ranks" << std::endl;
+        amrex::Error();
+    }
+
 #ifdef AGN
     pp.query("agn_particle_file", agn_particle_file);
     if (!agn_particle_file.empty() && particle_init_type != "AsciiFile")
@@ -330,6 +378,12 @@ Nyx::read_particle_params ()
     // move in a timestep).
     //
     ppp.query("cfl", particle_cfl);
+
+    ppp.query("max_rung", particle_max_rung);
+    if (particle_max_rung < 0 || particle_max_rung > 30)
+        amrex::Error("particles.max_rung must be between 0 and 30");
+    if (particle_max_rung > 0 && particle_move_type != "Gravitational")
+        amrex::Error("particles.max_rung > 0 needs particle_move_type = Gravitational");
 #ifdef NEUTRINO_PARTICLES
     ppp.query("neutrino_cfl", neutrino_cfl);
 #endif
@@ -370,6 +424,7 @@ Nyx::init_particles ()
         // 2 gives more stuff than 1.
         //
         DMPC->SetVerbose(particle_verbose);
+        DMPC->SetBlockTimestepping(particle_max_rung);
 
         if (particle_init_type == "Random")
         {
@@ -465,9 +520,20 @@ Nyx::init_particles ()
             // after reading in `m_pos[]`. Here we're reading in the particle
             // mass and velocity.
             //
-            DMPC->InitFromBinaryFile(binary_particle_file, BL_SPACEDIM + 1);
-            if (init_with_sph_particles == 1)
-                SPHPC->InitFromBinaryFile(ascii_particle_file, BL_SPACEDIM + 1);
+            if (binary_particle_readers != 0)
+            {
+                DMPC->InitFromBinaryFileParallel(binary_particle_file, BL_SPACEDIM + 1,
+                                                 binary_particle_readers);
+                if (init_with_sph_particles == 1)
+                    SPHPC->InitFromBinaryFileParallel(ascii_particle_file, BL_SPACEDIM + 1,
+                                                      binary_particle_readers);
+            }
+            else
+            {
+                DMPC->InitFromBinaryFile(binary_particle_file, BL_SPACEDIM + 1);
+                if (init_with_sph_particles == 1)
+                    SPHPC->InitFromBinaryFile(ascii_particle_file, BL_SPACEDIM + 1);
+            }
         }
         else if (particle_init_type == "BinaryMetaFile")
         {
@@ -493,6 +559,8 @@ Nyx::init_particles ()
             amrex::Error("not a valid input for nyx.particle_init_type");
         }
 
+        DMPC->DetectUniformMass();
+
         if (write_particle_density_at_init == 1)
         {
             MultiFab particle_mf(grids,dmap,1,1);
@@ -593,7 +661,11 @@ Nyx::init_particles ()
             // after reading in `m_pos[]`. Here we're reading in the particle
             // mass and velocity.
             //
-            NPC->InitFromBinaryFile(neutrino_particle_file, BL_SPACEDIM + 1);
+            if (binary_particle_readers != 0)
+                NPC->InitFromBinaryFileParallel(neutrino_particle_file, BL_SPACEDIM + 1,
+                                                binary_particle_readers);
+            else
+                NPC->InitFromBinaryFile(neutrino_particle_file, BL_SPACEDIM + 1);
         }
 
         else
@@ -794,7 +866,9 @@ Nyx::particle_post_restart (const std::string& restart_file, bool is_checkpoint)
         // 2 gives more stuff than 1.
         //
         DMPC->SetVerbose(particle_verbose);
+        DMPC->SetBlockTimestepping(particle_max_rung);
         DMPC->Restart(restart_file, chk_particle_file, is_checkpoint);
+        DMPC->DetectUniformMass();
         //
         // We want the ability to write the particles out to an ascii file.
         //
@@ -815,12 +889,18 @@ void
 Nyx::particle_est_time_step (Real& est_dt)
 {
     BL_PROFILE("Nyx::particle_est_time_step()");
-    if (DMPC && particle_move_type == "Gravitational")
+    if (DMPC && (particle_move_type == "Gravitational" || particle_move_type == "Direct"))
     {
         const Real cur_time = state[PhiGrav_Type].curTime();
         const Real a = get_comoving_a(cur_time);
         MultiFab& grav = get_new_data(Gravity_Type);
-        const Real est_dt_particle = DMPC->estTimestep(grav, a, level, particle_cfl);
+        //
+        // With block time steps the particles whose acceleration constraint
+        // is shorter than the step take substeps instead, as long as none
+        // of them can be pushed more than cfl cells by its acceleration.
+        //
+        const Real accel_fac = static_cast<Real>(1 << particle_max_rung);
+        const Real est_dt_particle = DMPC->estTimestep(grav, a, level, particle_cfl, accel_fac);
 
         if (est_dt_particle > 0) {
             est_dt = std::min(est_dt, est_dt_particle);
@@ -966,8 +1046,12 @@ Nyx::setup_virtual_particles()
         {
     	    get_level(level + 1).setup_virtual_particles();
 	    Nyx::theVirtPC()->CreateVirtualParticles(level+1, virts);
+            if (aggregate_virtual_particles)
+                Nyx::theVirtPC()->AggregateVirtualParticles(virts, level);
 	    Nyx::theVirtPC()->AddParticlesAtLevel(virts, level);
 	    Nyx::theDMPC()->CreateVirtualParticles(level+1, virts);
+            if (aggregate_virtual_particles)
+                Nyx::theDMPC()->AggregateVirtualParticles(virts, level);
 	    Nyx::theVirtPC()->AddParticlesAtLevel(virts, level);
         }
         virtual_particles_set = true;
@@ -994,9 +1078,33 @@ Nyx::setup_ghost_particles()
     int nGrow = Nyx::grav_n_grow - 1;
     if(Nyx::theDMPC() != 0)
     {
-        DarkMatterParticleContainer::AoS ghosts;
-        Nyx::theDMPC()->CreateGhostParticles(level, nGrow, ghosts);
-        Nyx::theGhostPC()->AddParticlesAtLevel(ghosts, level+1, nGrow);
+        if (persistent_ghost_particles)
+        {
+            if (ghosted_particles.size() <= level)
+            {
+                ghosted_particles.resize(level+1);
+                ghosts_synced_at.resize(level+1, -1);
+            }
+            //
+            // The ghosts are moved with the fine steps and their parents with
+            // ours, so they are copied afresh from their parents at the start
+            // of every coarse step and only kept across this level's subcycles.
+            //
+            if (ghosts_synced_at[level] != parent->levelSteps(0))
+            {
+                Nyx::theGhostPC()->RemoveParticlesAtLevel(level+1);
+                ghosted_particles[level].clear();
+                ghosts_synced_at[level] = parent->levelSteps(0);
+            }
+            Nyx::theDMPC()->UpdateGhostParticles(level, nGrow, *Nyx::theGhostPC(),
+                                                 ghosted_particles[level]);
+        }
+        else
+        {
+            DarkMatterParticleContainer::AoS ghosts;
+            Nyx::theDMPC()->CreateGhostParticles(level, nGrow, ghosts);
+            Nyx::theGhostPC()->AddParticlesAtLevel(ghosts, level+1, nGrow);
+        }
     }
 #ifdef AGN
     if(Nyx::theAPC() != 0)
@@ -1022,11 +1130,26 @@ Nyx::remove_ghost_particles()
     BL_PROFILE("Nyx::setup_ghost_particles()");
     for (int i = 0; i < GhostParticles.size(); i++)
     {
+        if (persistent_ghost_particles && GhostParticles[i] == GhostPC)
+            continue;
         if (GhostParticles[i] != 0)
             GhostParticles[i]->RemoveParticlesAtLevel(level);
     }
 }
 
+void
+Nyx::reset_ghost_particles(int lev_min)
+{
+    BL_PROFILE("Nyx::reset_ghost_particles()");
+    if (GhostPC == 0)
+        return;
+    for (int lev = lev_min; lev < ghosted_particles.size(); lev++)
+    {
+        GhostPC->RemoveParticlesAtLevel(lev+1);
+        ghosted_particles[lev].clear();
+    }
+}
+
 
 
 void
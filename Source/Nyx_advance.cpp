@@ -212,6 +212,9 @@ Nyx::advance_hydro_plus_particles (Real time,
                 MultiFab grav_vec_old(ba, dm, BL_SPACEDIM, grav_n_grow);
                 get_level(lev).gravity->get_old_grav_vector(lev, grav_vec_old, time);
                 
+                // The short-range part of the force, if split off, at the old positions
+                get_level(lev).gravity->short_range_kick(lev, 0.5*dt, a_old);
+
                 for (int i = 0; i < Nyx::theActiveParticles().size(); i++)
                     Nyx::theActiveParticles()[i]->moveKickDrift(grav_vec_old, lev, dt, a_old, a_half);
 
@@ -225,6 +228,13 @@ Nyx::advance_hydro_plus_particles (Real time,
                    Nyx::theGhostParticles()[i]->moveKickDrift(grav_vec_old, lev, dt, a_old, a_half);
             }
         }
+        else if (particle_move_type == "Direct")
+        {
+            if (level != 0 || finest_level_to_advance != finest_level)
+                amrex::Abort("particle_move_type = Direct needs all levels advanced together");
+
+            moveKickDriftExact(dt, a_old, 0.5 * (a_old + a_new));
+        }
     }
 
 #endif
@@ -421,14 +431,22 @@ Nyx::advance_hydro_plus_particles (Real time,
                 for (int i = 0; i < Nyx::theActiveParticles().size(); i++)
                     Nyx::theActiveParticles()[i]->moveKick(grav_vec_new, lev, dt, a_new, a_half);
 
+                get_level(lev).gravity->short_range_kick(lev, 0.5*dt, a_new);
+
                 // Virtual particles will be recreated, so we need not kick them.
 
-                // Ghost particles need to be kicked except during the final iteration.
-                if (iteration != ncycle)
-                    for (int i = 0; i < Nyx::theGhostParticles().size(); i++)
+                // Ghost particles need to be kicked except during the final iteration,
+                // after which they are removed -- unless they are kept for the next step.
+                for (int i = 0; i < Nyx::theGhostParticles().size(); i++)
+                    if (iteration != ncycle ||
+                        (persistent_ghost_particles && Nyx::theGhostParticles()[i] == Nyx::theGhostPC()))
                         Nyx::theGhostParticles()[i]->moveKick(grav_vec_new, lev, dt, a_new, a_half);
             }
         }
+        else if (particle_move_type == "Direct")
+        {
+            moveKickExact(dt, a_new, 0.5 * (a_old + a_new));
+        }
     }
 #endif
 
@@ -85,12 +85,14 @@ Nyx::just_the_hydro (Real time,
        if (strang_split)
        {
           std::cout << "Source terms are handled with strang splitting" << std::endl; 
+       } else if (sdc_split) {
+          std::cout << "Source terms are handled with simplified SDC" << std::endl; 
        } else {
           std::cout << "Source terms are handled with predictor/corrector" << std::endl; 
        }
     }
 
-    if (add_ext_src && !strang_split)
+    if (add_ext_src && !strang_split && !sdc_split)
     {
 #ifndef NO_OLD_SRC
         get_old_source(prev_time, dt, ext_src_old);
@@ -293,7 +295,7 @@ Nyx::just_the_hydro (Real time,
     }
 #endif
 
-    if (add_ext_src && !strang_split)
+    if (add_ext_src && !strang_split && !sdc_split)
     {
         get_old_source(prev_time, dt, ext_src_old);
         // Must compute new temperature in case it is needed in the source term
@@ -309,7 +311,20 @@ Nyx::just_the_hydro (Real time,
         time_center_source_terms(S_new, ext_src_old, ext_src_new, dt);
 
         compute_new_temp();
-    } // end if (add_ext_src && !strang_split)
+    } // end if (add_ext_src && !strang_split && !sdc_split)
+
+    // This replaces the hydro-only (rho e) with one integrated together with
+    // heating/cooling, and updates (rho E), Temperature and Ne
+    if (add_ext_src && sdc_split)
+    {
+        const Real strt_sdc = ParallelDescriptor::second();
+        sdc_heat_cool(time,dt,S_old_tmp,S_new,D_new);
+        Real end = ParallelDescriptor::second() - strt_sdc;
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor() && show_timings)
+           std::cout << "Time in sdc heating/cooling " << end << '\n';
+    }
 
 #ifndef NDEBUG
     if (S_new.contains_nan(Density, S_new.nComp(), 0))
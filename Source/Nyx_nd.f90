@@ -365,10 +365,6 @@
 
         end if
 
-        if (heat_cool_type .eq. 1 .or. heat_cool_type .eq. 3) then
-           call tabulate_rates()
-        end if
-
         ! Easy indexing for the passively advected quantities.  
         ! This lets us loop over all four groups (advected, species, aux)
         ! in a single loop.
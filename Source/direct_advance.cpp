@@ -0,0 +1,134 @@
+#ifdef  GRAVITY
+
+#include "Nyx.H"
+#include "Nyx_F.H"
+#include "Gravity.H"
+#include <AMReX_Particles_F.H>
+
+using namespace amrex;
+
+extern "C"
+{void fort_get_grav_const(Real* Gconst);}
+
+using std::string;
+
+//
+// Dark matter accelerations at scale factor a by direct summation, in the
+// units of the mesh gravity vector: -grad(phi) with Lap(phi) = 4 pi G rho / a.
+//
+void
+Nyx::direct_accelerations (Array<Real>& accel, Real a)
+{
+    const Real strt = ParallelDescriptor::second();
+
+    Real Gconst;
+    fort_get_grav_const(&Gconst);
+
+    Nyx::theDMPC()->DirectAccelerations(accel, Gconst / a, direct_eps);
+
+    if (particle_verbose > 1)
+    {
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        Real end = ParallelDescriptor::second() - strt;
+        ParallelDescriptor::ReduceRealMax(end,IOProc);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Nyx::direct_accelerations() time: " << end << '\n';
+    }
+}
+
+void
+Nyx::moveKickDriftExact (Real dt, Real a_old, Real a_half)
+{
+    BL_PROFILE("Nyx::moveKickDriftExact()");
+
+    if (particle_verbose && ParallelDescriptor::IOProcessor())
+        std::cout << "moveKickDriftExact ... direct summation of the particle forces\n";
+
+    Array<Real> accel;
+    direct_accelerations(accel, a_old);
+    Nyx::theDMPC()->DirectKickDrift(accel, dt, a_old, a_half, 1);
+}
+
+void
+Nyx::moveKickExact (Real dt, Real a_new, Real a_half)
+{
+    BL_PROFILE("Nyx::moveKickExact()");
+
+    if (particle_verbose && ParallelDescriptor::IOProcessor())
+        std::cout << "moveKickExact ... direct summation of the particle forces\n";
+
+    Array<Real> accel;
+    direct_accelerations(accel, a_new);
+    Nyx::theDMPC()->DirectKickDrift(accel, dt, a_half, a_new, 0);
+}
+
+//
+// Compare the mesh gravity on the dark matter at each level with direct
+// summation, reporting the rms and largest relative errors.
+//
+void
+Nyx::check_direct_forces (Real time)
+{
+    BL_PROFILE("Nyx::check_direct_forces()");
+
+    const Real a = get_comoving_a(time);
+
+    Array<Real> acc_direct;
+    direct_accelerations(acc_direct, a);
+
+    Array<Real> acc_mesh;
+    Array<long> level_end;
+    for (int lev = 0; lev <= parent->finestLevel(); lev++)
+    {
+        const auto& ba = get_level(lev).get_new_data(PhiGrav_Type).boxArray();
+        const auto& dm = get_level(lev).get_new_data(PhiGrav_Type).DistributionMap();
+        MultiFab grav_vec(ba, dm, BL_SPACEDIM, grav_n_grow);
+        get_level(lev).gravity->get_new_grav_vector(lev, grav_vec, time);
+
+        Nyx::theDMPC()->MeshAccelerations(acc_mesh, lev, grav_vec);
+        level_end.push_back(acc_mesh.size() / BL_SPACEDIM);
+    }
+
+    BL_ASSERT(acc_mesh.size() == acc_direct.size());
+
+    const int nlevs = level_end.size();
+
+    // Per level: count, sum of squared relative errors, largest relative error
+    Array<Real> sums(2*nlevs, 0), maxs(nlevs, 0);
+    long n = 0;
+    for (int lev = 0; lev < nlevs; lev++)
+    {
+        for ( ; n < level_end[lev]; n++)
+        {
+            Real err2 = 0, mag2 = 0;
+            for (int d = 0; d < BL_SPACEDIM; d++)
+            {
+                const Real e = acc_mesh[BL_SPACEDIM*n+d] - acc_direct[BL_SPACEDIM*n+d];
+                err2 += e * e;
+                mag2 += acc_direct[BL_SPACEDIM*n+d] * acc_direct[BL_SPACEDIM*n+d];
+            }
+            if (mag2 == 0) continue;
+
+            const Real rel = std::sqrt(err2 / mag2);
+            sums[2*lev  ] += 1;
+            sums[2*lev+1] += rel * rel;
+            maxs[lev]      = std::max(maxs[lev], rel);
+        }
+    }
+
+    ParallelDescriptor::ReduceRealSum(sums.dataPtr(), 2*nlevs);
+    ParallelDescriptor::ReduceRealMax(maxs.dataPtr(), nlevs);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "Mesh vs direct forces on the dark matter at z = " << 1/a - 1 << ":\n";
+        for (int lev = 0; lev < nlevs; lev++)
+        {
+            if (sums[2*lev] == 0) continue;
+            std::cout << "   level " << lev << ": " << static_cast<long>(sums[2*lev]) << " particles"
+                      << ", rms relative error " << std::sqrt(sums[2*lev+1] / sums[2*lev])
+                      << ", max " << maxs[lev] << '\n';
+        }
+    }
+}
+#endif
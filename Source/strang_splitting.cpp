@@ -1,10 +1,81 @@
 
+#include <iomanip>
+#include <sstream>
+
 #include "Nyx.H"
 #include "Nyx_F.H"
 
 using namespace amrex;
 using std::string;
 
+// Number of power-of-two bins in the heating/cooling cost histograms
+static const int hc_hist_nbins = 16;
+
+//
+// Bin the cells of bx by the number of RHS evaluations (component 0 of
+// hc_cost) and integrator steps (component 1).  Bin 0 holds counts of
+// 0 and 1, bin b > 0 holds counts in [2^b, 2^(b+1)).
+//
+static
+void
+add_to_hc_histograms (const FArrayBox& hc_cost,
+                      const Box&       bx,
+                      Array<long>&     rhs_hist,
+                      Array<long>&     steps_hist)
+{
+    for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv))
+    {
+        for (int n = 0; n < 2; n++)
+        {
+            long count = static_cast<long>(hc_cost(iv,n));
+            int  bin   = 0;
+            while (count > 1 && bin < hc_hist_nbins-1)
+            {
+                count >>= 1;
+                bin++;
+            }
+            if (n == 0)
+                rhs_hist[bin]++;
+            else
+                steps_hist[bin]++;
+        }
+    }
+}
+
+static
+void
+print_hc_histograms (const std::string& label,
+                     Array<long>&       rhs_hist,
+                     Array<long>&       steps_hist)
+{
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceLongSum(rhs_hist.dataPtr(),   hc_hist_nbins, IOProc);
+    ParallelDescriptor::ReduceLongSum(steps_hist.dataPtr(), hc_hist_nbins, IOProc);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::cout << "Heating/cooling cost in " << label << " (number of cells):" << '\n';
+        std::cout << std::setw(22) << "count"
+                  << std::setw(14) << "RHS calls"
+                  << std::setw(14) << "steps" << '\n';
+        for (int b = 0; b < hc_hist_nbins; b++)
+        {
+            if (rhs_hist[b] == 0 && steps_hist[b] == 0)
+                continue;
+            const long lo = (b == 0) ? 0 : (1L << b);
+            const long hi = (1L << (b+1)) - 1;
+            std::ostringstream range;
+            if (b == hc_hist_nbins-1)
+                range << lo << " - ";
+            else
+                range << lo << " - " << hi;
+            std::cout << std::setw(22) << range.str()
+                      << std::setw(14) << rhs_hist[b]
+                      << std::setw(14) << steps_hist[b] << '\n';
+        }
+    }
+}
+
 void
 Nyx::strang_first_step (Real time, Real dt, MultiFab& S_old, MultiFab& D_old)
 {
@@ -13,21 +84,38 @@ Nyx::strang_first_step (Real time, Real dt, MultiFab& S_old, MultiFab& D_old)
 
     const Real a = get_comoving_a(time);
 
+#ifdef HEATCOOL
+    // Every cell carries one unit of hydro work; the heating/cooling
+    // cost of both Strang half steps is added on top of that.
+    MultiFab& W_new = get_new_data(Work_Estimate_Type);
+    W_new.setVal(1.0);
+#endif
+
+    Array<long> rhs_hist(hc_hist_nbins,0), steps_hist(hc_hist_nbins,0);
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (MFIter mfi(S_old,true); mfi.isValid(); ++mfi)
     {
-        // Note that this "bx" includes the grow cells 
+      FArrayBox hc_cost;
+      Array<long> rhs_hist_loc(hc_hist_nbins,0), steps_hist_loc(hc_hist_nbins,0);
+
+      for (MFIter mfi(S_old,true); mfi.isValid(); ++mfi)
+      {
+        // Note that this "bx" includes the grow cells
         const Box& bx = mfi.growntilebox(S_old.nGrow());
 
         int  min_iter = 100000;
         int  max_iter =      0;
 
+        hc_cost.resize(bx,2);
+        hc_cost.setVal(0);
+
         integrate_state
-                (bx.loVect(), bx.hiVect(), 
+                (bx.loVect(), bx.hiVect(),
                  BL_TO_FORTRAN(S_old[mfi]),
                  BL_TO_FORTRAN(D_old[mfi]),
+                 BL_TO_FORTRAN(hc_cost),
                  &a, &half_dt, &min_iter, &max_iter);
 
 #ifndef NDEBUG
@@ -35,7 +123,27 @@ Nyx::strang_first_step (Real time, Real dt, MultiFab& S_old, MultiFab& D_old)
             amrex::Abort("state has NaNs after the first strang call");
 #endif
 
+        // Only the valid cells are charged to this grid
+        const Box& vbx = mfi.tilebox();
+#ifdef HEATCOOL
+        W_new[mfi].plus(hc_cost, vbx, vbx, 0, 0, 1);
+#endif
+        if (verbose)
+            add_to_hc_histograms(hc_cost, vbx, rhs_hist_loc, steps_hist_loc);
+      }
+
+#ifdef _OPENMP
+#pragma omp critical (strang_hc_hist)
+#endif
+      for (int b = 0; b < hc_hist_nbins; b++)
+      {
+          rhs_hist[b]   += rhs_hist_loc[b];
+          steps_hist[b] += steps_hist_loc[b];
+      }
     }
+
+    if (verbose)
+        print_hc_histograms("first Strang step", rhs_hist, steps_hist);
 }
 
 void
@@ -46,28 +154,41 @@ Nyx::strang_second_step (Real time, Real dt, MultiFab& S_new, MultiFab& D_new)
     int  min_iter = 100000;
     int  max_iter =      0;
 
-    int min_iter_grid;
-    int max_iter_grid;
-
     const Real a = get_comoving_a(time);
 
     compute_new_temp();
 
+#ifdef HEATCOOL
+    MultiFab& W_new = get_new_data(Work_Estimate_Type);
+#endif
+
+    Array<long> rhs_hist(hc_hist_nbins,0), steps_hist(hc_hist_nbins,0);
+
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (MFIter mfi(S_new,true); mfi.isValid(); ++mfi)
     {
+      FArrayBox hc_cost;
+      Array<long> rhs_hist_loc(hc_hist_nbins,0), steps_hist_loc(hc_hist_nbins,0);
+      int min_iter_loc = 100000;
+      int max_iter_loc =      0;
+
+      for (MFIter mfi(S_new,true); mfi.isValid(); ++mfi)
+      {
         // Here bx is just the valid region
         const Box& bx = mfi.tilebox();
 
-        min_iter_grid = 100000;
-        max_iter_grid =      0;
+        int min_iter_grid = 100000;
+        int max_iter_grid =      0;
+
+        hc_cost.resize(bx,2);
+        hc_cost.setVal(0);
 
         integrate_state
-            (bx.loVect(), bx.hiVect(), 
+            (bx.loVect(), bx.hiVect(),
              BL_TO_FORTRAN(S_new[mfi]),
              BL_TO_FORTRAN(D_new[mfi]),
+             BL_TO_FORTRAN(hc_cost),
              &a, &half_dt, &min_iter_grid, &max_iter_grid);
 
         if (S_new[mfi].contains_nan(bx,0,S_new.nComp()))
@@ -75,8 +196,28 @@ Nyx::strang_second_step (Real time, Real dt, MultiFab& S_new, MultiFab& D_new)
             std::cout << "NANS IN THIS GRID " << bx << std::endl;
         }
 
-        min_iter = std::min(min_iter,min_iter_grid);
-        max_iter = std::max(max_iter,max_iter_grid);
+#ifdef HEATCOOL
+        W_new[mfi].plus(hc_cost, bx, bx, 0, 0, 1);
+#endif
+        if (verbose)
+            add_to_hc_histograms(hc_cost, bx, rhs_hist_loc, steps_hist_loc);
+
+        min_iter_loc = std::min(min_iter_loc,min_iter_grid);
+        max_iter_loc = std::max(max_iter_loc,max_iter_grid);
+      }
+
+#ifdef _OPENMP
+#pragma omp critical (strang_hc_hist)
+#endif
+      {
+        min_iter = std::min(min_iter,min_iter_loc);
+        max_iter = std::max(max_iter,max_iter_loc);
+        for (int b = 0; b < hc_hist_nbins; b++)
+        {
+            rhs_hist[b]   += rhs_hist_loc[b];
+            steps_hist[b] += steps_hist_loc[b];
+        }
+      }
     }
 
     ParallelDescriptor::ReduceIntMax(max_iter);
@@ -85,4 +226,128 @@ Nyx::strang_second_step (Real time, Real dt, MultiFab& S_new, MultiFab& D_new)
     if (heat_cool_type == 1)
         if (ParallelDescriptor::IOProcessor())
             std::cout << "Min/Max Number of Iterations in Second Strang: " << min_iter << " " << max_iter << std::endl;
+
+    if (verbose)
+        print_hc_histograms("second Strang step", rhs_hist, steps_hist);
+
+#ifdef HEATCOOL
+    if (verbose)
+    {
+        //
+        // Sum the work estimate over each grid, then over the grids owned by
+        // each rank, to see how well the current distribution map balances it.
+        //
+        const int IOProc = ParallelDescriptor::IOProcessorNumber();
+        const int nprocs = ParallelDescriptor::NProcs();
+
+        Array<Real> grid_work(grids.size(),0);
+        for (MFIter mfi(W_new); mfi.isValid(); ++mfi)
+            grid_work[mfi.index()] = W_new[mfi].sum(mfi.validbox(),0);
+        ParallelDescriptor::ReduceRealSum(grid_work.dataPtr(), grid_work.size(), IOProc);
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            Array<Real> rank_work(nprocs,0);
+            for (int i = 0; i < grid_work.size(); i++)
+                rank_work[dmap[i]] += grid_work[i];
+
+            Real max_work = 0, tot_work = 0;
+            for (int p = 0; p < nprocs; p++)
+            {
+                max_work  = std::max(max_work, rank_work[p]);
+                tot_work += rank_work[p];
+            }
+            const Real avg_work = tot_work / nprocs;
+
+            std::cout << "Work estimate at level " << level
+                      << ": total " << tot_work
+                      << ", max/mean per rank " << max_work / avg_work << '\n';
+
+            if (verbose > 1)
+                for (int i = 0; i < grid_work.size(); i++)
+                    std::cout << "   grid " << i << " on rank " << dmap[i]
+                              << ": " << grid_work[i] << '\n';
+        }
+    }
+#endif
+}
+
+void
+Nyx::sdc_heat_cool (Real time, Real dt, MultiFab& S_old, MultiFab& S_new, MultiFab& D_new)
+{
+    BL_PROFILE("Nyx::sdc_heat_cool()");
+    int  min_iter = 100000;
+    int  max_iter =      0;
+
+    // The rates are evaluated at the middle of the step
+    const Real a = get_comoving_a(time + 0.5*dt);
+
+#ifdef HEATCOOL
+    MultiFab& W_new = get_new_data(Work_Estimate_Type);
+    W_new.setVal(1.0);
+#endif
+
+    Array<long> rhs_hist(hc_hist_nbins,0), steps_hist(hc_hist_nbins,0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      FArrayBox hc_cost;
+      Array<long> rhs_hist_loc(hc_hist_nbins,0), steps_hist_loc(hc_hist_nbins,0);
+      int min_iter_loc = 100000;
+      int max_iter_loc =      0;
+
+      for (MFIter mfi(S_new,true); mfi.isValid(); ++mfi)
+      {
+        // Only the valid region: the hydro update is not defined in the grow cells
+        const Box& bx = mfi.tilebox();
+
+        hc_cost.resize(bx,2);
+        hc_cost.setVal(0);
+
+        integrate_state_with_source
+            (bx.loVect(), bx.hiVect(),
+             BL_TO_FORTRAN(S_old[mfi]),
+             BL_TO_FORTRAN(S_new[mfi]),
+             BL_TO_FORTRAN(D_new[mfi]),
+             BL_TO_FORTRAN(hc_cost),
+             &a, &dt, &min_iter_loc, &max_iter_loc);
+
+#ifndef NDEBUG
+        if (S_new[mfi].contains_nan(bx,0,S_new.nComp()))
+            amrex::Abort("state has NaNs after the sdc heating/cooling");
+#endif
+
+#ifdef HEATCOOL
+        W_new[mfi].plus(hc_cost, bx, bx, 0, 0, 1);
+#endif
+        if (verbose)
+            add_to_hc_histograms(hc_cost, bx, rhs_hist_loc, steps_hist_loc);
+      }
+
+#ifdef _OPENMP
+#pragma omp critical (strang_hc_hist)
+#endif
+      {
+        min_iter = std::min(min_iter,min_iter_loc);
+        max_iter = std::max(max_iter,max_iter_loc);
+        for (int b = 0; b < hc_hist_nbins; b++)
+        {
+            rhs_hist[b]   += rhs_hist_loc[b];
+            steps_hist[b] += steps_hist_loc[b];
+        }
+      }
+    }
+
+    if (verbose)
+    {
+        ParallelDescriptor::ReduceIntMax(max_iter);
+        ParallelDescriptor::ReduceIntMin(min_iter);
+        if (ParallelDescriptor::IOProcessor())
+            std::cout << "Min/Max Number of VODE steps in sdc heating/cooling: "
+                      << min_iter << " " << max_iter << std::endl;
+
+        print_hc_histograms("sdc heating/cooling", rhs_hist, steps_hist);
+    }
 }